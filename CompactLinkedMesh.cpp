@@ -0,0 +1,620 @@
+#include "core/mesh/CompactLinkedMesh.hpp"
+
+template<typename Traits>
+const uint32_t BasicCompactLinkedMesh<Traits>::invalid;
+
+namespace
+{
+    template<typename T>
+    inline size_t vector_bytes( const std::vector<T> & vector )
+    {
+        return vector.capacity() * sizeof( T );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+BasicCompactLinkedMesh<Traits>::BasicCompactLinkedMesh() :
+    m_vertex_color( vec4( 1.0f, 1.0f, 1.0f, 1.0f ) ),
+    m_vertex_light( 0.5f ),
+    m_face_color( vec4( 1.0f, 1.0f, 1.0f, 1.0f ) )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+BasicCompactLinkedMesh<Traits>::~BasicCompactLinkedMesh()
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::reserve( const size_t vertex_count, const size_t edge_count, const size_t face_count )
+{
+    m_vertex_position.reserve( vertex_count );
+    m_vertex_color.reserve( vertex_count );
+    m_vertex_light.reserve( vertex_count );
+    m_vertex_initialized.reserve( vertex_count );
+
+    m_edge_vertex.reserve( edge_count );
+    m_edge_next.reserve( edge_count );
+    m_edge_opposing.reserve( edge_count );
+    m_edge_face.reserve( edge_count );
+    m_edge_texcoord.reserve( edge_count );
+
+    m_face_edge.reserve( face_count );
+    m_face_normal.reserve( face_count );
+    m_face_color.reserve( face_count );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::set_bounds( const vec3 & min, const vec3 & max )
+{
+    set_quantization_bounds( m_vertex_position, min, max );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::set_color( const FaceHandle face, const vec4 & color )
+{
+    const auto first_edge = m_face_edge[face.index];
+    auto edge = first_edge;
+
+    assert( m_edge_vertex[edge] != invalid );
+
+    do
+    {
+        m_vertex_color.set( m_edge_vertex[edge], color );
+    }
+    while( ( edge = m_edge_next[edge] ) != first_edge );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::set_color( const unsigned int face_index, const vec4 & color )
+{
+    assert( face_index < m_face_edge.size() );
+    m_face_color.set( face_index, color );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::set_texcoord( const unsigned int face_index, const std::vector<vec2> & new_texcoords )
+{
+    assert( face_index < m_face_edge.size() );
+    const auto first_edge = m_face_edge[face_index];
+    auto edge = first_edge;
+
+    size_t edge_count = 0;
+
+    do
+    {
+        m_edge_texcoord.set( edge, new_texcoords[edge_count++] );
+    }
+    while( ( edge = m_edge_next[edge] ) != first_edge );
+
+    /// make sure the face has exactly as many vertices as new_texcoords were passed in
+    assert( edge_count == new_texcoords.size() );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::VertexHandle BasicCompactLinkedMesh<Traits>::add_vertex( const vec3 & position, const vec4 & color )
+{
+    uint32_t new_vertex;
+
+    if( !m_free_vertices.empty() )
+    {
+        new_vertex = m_free_vertices.back();
+        m_free_vertices.pop_back();
+        m_vertex_position.set( new_vertex, position );
+        m_vertex_color.set( new_vertex, color );
+    }
+    else
+    {
+        new_vertex = static_cast<uint32_t>( m_vertex_position.size() );
+        m_vertex_position.emplace_back( position );
+        m_vertex_color.emplace_back( color );
+        m_vertex_light.emplace_back( 0.5f );
+        m_vertex_initialized.emplace_back( 0 );
+    }
+
+    assert( m_vertex_initialized[new_vertex] == 0 );
+    m_vertex_initialized[new_vertex] = 1;
+
+    return VertexHandle( new_vertex );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::EdgeHandle BasicCompactLinkedMesh<Traits>::add_halfedge( const VertexHandle vertex )
+{
+    uint32_t new_edge;
+
+    if( !m_free_edges.empty() )
+    {
+        /// use a free edge if possible
+        new_edge = m_free_edges.back();
+        m_free_edges.pop_back();
+        assert( m_edge_vertex[new_edge] == invalid );
+        m_edge_vertex[new_edge] = vertex.index;
+    }
+    else
+    {
+        /// otherwise allocate a new edge
+        new_edge = static_cast<uint32_t>( m_edge_vertex.size() );
+        m_edge_vertex.emplace_back( vertex.index );
+        m_edge_next.emplace_back( invalid );
+        m_edge_opposing.emplace_back( invalid );
+        m_edge_face.emplace_back( invalid );
+        m_edge_texcoord.emplace_back( 0.0f, 0.0f );
+    }
+
+    return EdgeHandle( new_edge );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec4 & color )
+{
+    EdgeLoop edge_loop;
+    edge_loop.emplace_back( add_halfedge( add_vertex( p0, color ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( p1, color ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( p2, color ) ) );
+    return add_face( edge_loop );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec3 & p3, const vec4 & color )
+{
+    EdgeLoop edge_loop;
+    edge_loop.emplace_back( add_halfedge( add_vertex( p0, color ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( p1, color ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( p2, color ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( p3, color ) ) );
+    return add_face( edge_loop );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::add_face( EdgeLoop && edges )
+{
+    return add_face( edges );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::add_face( EdgeLoop & edges )
+{
+    assert( edges.size() > 2 );
+
+    uint32_t new_face;
+
+    if( !m_free_faces.empty() )
+    {
+        /// if there is a free face on the stack reuse it
+        new_face = m_free_faces.back();
+        m_free_faces.pop_back();
+        assert( m_face_edge[new_face] == invalid );
+        m_face_edge[new_face] = edges.front().index;
+    }
+    else
+    {
+        /// when there is no free faces stacked allocate a new
+        new_face = static_cast<uint32_t>( m_face_edge.size() );
+        m_face_edge.emplace_back( edges.front().index );
+        m_face_normal.emplace_back( 0.0f, 0.0f, 0.0f );
+        m_face_color.emplace_back( 1.0f, 1.0f, 1.0f, 1.0f );
+    }
+
+    static const vec2 quad_texcoords[] =
+    {
+        vec2( 0.0f, 0.0f ),
+        vec2( 1.0f, 0.0f ),
+        vec2( 1.0f, 1.0f ),
+        vec2( 0.0f, 1.0f )
+    };
+
+    /// make edgeloop
+    for( unsigned int i = 0; i < edges.size(); ++i )
+    {
+        const auto edge = edges[i].index;
+
+        if( m_edge_next[edge] != invalid )
+        {
+            std::cout << "error index:" << i << std::endl;
+            throw 1;
+        }
+
+        m_edge_next[edge] = edges[( i+1 )%edges.size()].index;
+        m_edge_face[edge] = new_face;
+
+        if( i < 4 )
+        {
+            m_edge_texcoord.set( edge, quad_texcoords[i] );
+        }
+    }
+
+    /// evaluate normal from three unique positions, unless the traits omit normals
+    if( Traits::FaceNormal::stored )
+    {
+        const auto & p0 = m_vertex_position[m_edge_vertex[edges[0].index]];
+        const auto & p1 = m_vertex_position[m_edge_vertex[edges[1].index]];
+        const auto & p2 = m_vertex_position[m_edge_vertex[edges[2].index]];
+
+        m_face_normal.set( new_face, glm::normalize( glm::cross( ( p0 - p1 ), ( p0 - p2 ) ) ) );
+    }
+
+    m_face_color.set( new_face, m_vertex_color[m_edge_vertex[edges[0].index]] );
+
+    return FaceHandle( new_face );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::bridge_edges( const EdgeHandle edge_left, const EdgeHandle edge_right )
+{
+    assert( next( edge_left ) && next( edge_right ) );
+    assert( !opposing( edge_left ) && !opposing( edge_right ) );
+
+    EdgeLoop edge_loop;
+
+    VertexHandle vertex[] =
+    {
+        this->vertex( edge_left ),
+        this->vertex( next( edge_left ) ),
+        this->vertex( edge_right ),
+        this->vertex( next( edge_right ) )
+    };
+
+    /// see LinkedMesh::bridge_edges for the cases handled here
+    if( vertex[0] == vertex[3] && vertex[1] == vertex[2] )
+    {
+        link_edges( edge_left, edge_right );
+        return FaceHandle();
+    }
+    else
+    {
+        edge_loop.emplace_back( add_halfedge( vertex[1] ) );
+        link_edges( edge_loop.back(), edge_left );
+        edge_loop.emplace_back( add_halfedge( vertex[0] ) );
+        if( vertex[0] != vertex[3] )
+        {
+            edge_loop.emplace_back( add_halfedge( vertex[3] ) );
+        }
+        link_edges( edge_loop.back(), edge_right );
+        if( vertex[1] != vertex[2] )
+        {
+            edge_loop.emplace_back( add_halfedge( vertex[2] ) );
+        }
+    }
+    return add_face( edge_loop );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::extrude_vertex( const EdgeHandle edge, vec3 offset )
+{
+    assert( next( edge ) );
+    assert( !opposing( edge ) );
+
+    VertexHandle vertex[] =
+    {
+        this->vertex( edge ),
+        this->vertex( next( edge ) )
+    };
+
+    EdgeLoop edge_loop;
+    edge_loop.emplace_back( add_halfedge( vertex[1] ) );
+    link_edges( edge_loop.back(), edge );
+    edge_loop.emplace_back( add_halfedge( vertex[0] ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( m_vertex_position[vertex[0].index] + offset ) ) );
+
+    return add_face( edge_loop );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::extrude_edge( const EdgeHandle edge, const vec3 & offset )
+{
+    assert( next( edge ) );
+    assert( !opposing( edge ) );
+
+    VertexHandle vertex[] =
+    {
+        this->vertex( edge ),
+        this->vertex( next( edge ) )
+    };
+
+    /// copy the attributes, add_vertex may grow the arrays they live in
+    const vec3 position0 = m_vertex_position[vertex[0].index];
+    const vec3 position1 = m_vertex_position[vertex[1].index];
+    const vec4 color0 = m_vertex_color[vertex[0].index];
+    const vec4 color1 = m_vertex_color[vertex[1].index];
+
+    EdgeLoop edge_loop;
+    edge_loop.emplace_back( add_halfedge( vertex[1] ) );
+    link_edges( edge_loop.back(), edge );
+    edge_loop.emplace_back( add_halfedge( vertex[0] ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( position0 + offset, color0 ) ) );
+    edge_loop.emplace_back( add_halfedge( add_vertex( position1 + offset, color1 ) ) );
+
+    return add_face( edge_loop );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+typename BasicCompactLinkedMesh<Traits>::FaceHandle BasicCompactLinkedMesh<Traits>::extrude_face( const FaceHandle face, const vec3 & offset )
+{
+    std::vector<FaceHandle> extruded_faces;
+    EdgeLoop cap_edges;
+    const auto first_edge = edge( face );
+    auto current = first_edge;
+
+    do
+    {
+        extruded_faces.emplace_back( extrude_edge( current, offset ) );
+    }
+    while( ( current = next( current ) ) != first_edge );
+
+    for( unsigned int i = 0; i < extruded_faces.size(); ++i )
+    {
+        auto next_in_loop = ( i+1 )%extruded_faces.size();
+
+        const auto side = edge( extruded_faces[i] );
+        const auto next_side = edge( extruded_faces[next_in_loop] );
+
+        link_edges( next( next( next( side ) ) ), next( next_side ) );
+
+        cap_edges.emplace_back( add_halfedge( vertex( next( next( side ) ) ) ) );
+        link_edges( next( next( side ) ), cap_edges.back() );
+    }
+
+    return add_face( cap_edges );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::points( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
+{
+    for( size_t i = 0; i < m_vertex_position.size(); ++i )
+    {
+        /// skip vertices on the free list
+        if( !m_vertex_initialized[i] ) continue;
+
+        const auto & position = m_vertex_position[i];
+        const auto & color = m_vertex_color[i];
+
+        position_buffer.emplace_back( position[0] );
+        position_buffer.emplace_back( position[1] );
+        position_buffer.emplace_back( position[2] );
+        position_buffer.emplace_back( 1.0f );
+
+        color_buffer.emplace_back( color[0] );
+        color_buffer.emplace_back( color[1] );
+        color_buffer.emplace_back( color[2] );
+        color_buffer.emplace_back( 1.0f );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::triangles( std::vector<Mesh::Vertex> & vertices )
+{
+    auto barycenter = vec3();
+
+    auto corner = [this]( const uint32_t edge, const vec3 & normal, const vec3 & barycenter )
+    {
+        const auto vertex = m_edge_vertex[edge];
+        return Mesh::Vertex( vec4( m_vertex_position[vertex], 1.0f ), m_vertex_color[vertex], normal, m_edge_texcoord[edge], barycenter, m_vertex_light[vertex] );
+    };
+
+    for( size_t face = 0; face < m_face_edge.size(); ++face )
+    {
+        if( m_face_edge[face] == invalid ) continue;
+
+        const auto & normal = m_face_normal[face];
+        const auto first_edge = m_face_edge[face];
+        auto edge = first_edge;
+        unsigned int vertex_count = 0;
+        unsigned int barycenter_index = 0;
+
+        do
+        {
+            barycenter = vec3( 0.0f, 0.0f, 0.0f );
+            barycenter[barycenter_index++] = 1.0f;
+
+            vertices.push_back( corner( edge, normal, barycenter ) );
+            if( ++vertex_count % 3 == 0 )
+            {
+                barycenter_index = 0;
+                barycenter = vec3( 0.0f, 0.0f, 0.0f );
+                barycenter[barycenter_index++] = 1.0f;
+                vertices.push_back( corner( edge, normal, barycenter ) );
+            }
+            edge = m_edge_next[edge];
+        }
+        while( edge != first_edge );
+        vertices.push_back( corner( edge, normal, vec3( 0.0f, 0.0f, 1.0f ) ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::triangles( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
+{
+    auto emit = [&]( const uint32_t edge )
+    {
+        const auto vertex = m_edge_vertex[edge];
+        assert( vertex != invalid );
+
+        const auto & position = m_vertex_position[vertex];
+        const auto & color = m_vertex_color[vertex];
+
+        position_buffer.emplace_back( position[0] );
+        position_buffer.emplace_back( position[1] );
+        position_buffer.emplace_back( position[2] );
+        position_buffer.emplace_back( 1.0f );
+
+        color_buffer.emplace_back( color[0] );
+        color_buffer.emplace_back( color[1] );
+        color_buffer.emplace_back( color[2] );
+        color_buffer.emplace_back( color[3] );
+    };
+
+    /// every face stored
+    for( size_t face = 0; face < m_face_edge.size(); ++face )
+    {
+        if( m_face_edge[face] == invalid )
+        {
+            continue;
+        }
+
+        /// starting edge of this edgeloop, used as break condition
+        const auto first_edge = m_face_edge[face];
+
+        /// current edge in the process
+        auto edge = m_edge_next[first_edge];
+
+        ///count the number of vertices triangulated
+        unsigned int vertex_counter = 0;
+
+        /// every edge in edgeloop, emitted as a fan around the first edge
+        while( edge != first_edge )
+        {
+            emit( edge );
+
+            if( ( ++vertex_counter % 2 ) == 0 )
+            {
+                emit( first_edge );
+
+                if( m_edge_next[edge] == first_edge )
+                {
+                    break;
+                }
+            }
+            else
+            {
+                edge = m_edge_next[edge];
+            }
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::clear()
+{
+    m_free_vertices.clear();
+    m_free_edges.clear();
+    m_free_faces.clear();
+
+    m_edge_vertex.clear();
+    m_edge_next.clear();
+    m_edge_opposing.clear();
+    m_edge_face.clear();
+    m_edge_texcoord.clear();
+
+    m_face_edge.clear();
+    m_face_normal.clear();
+    m_face_color.clear();
+
+    m_vertex_position.clear();
+    m_vertex_color.clear();
+    m_vertex_light.clear();
+    m_vertex_initialized.clear();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+size_t BasicCompactLinkedMesh<Traits>::allocated_bytes() const
+{
+    return vector_bytes( m_free_vertices ) + vector_bytes( m_free_edges ) + vector_bytes( m_free_faces ) +
+           vector_bytes( m_edge_vertex ) + vector_bytes( m_edge_next ) + vector_bytes( m_edge_opposing ) +
+           vector_bytes( m_edge_face ) + m_edge_texcoord.allocated_bytes() +
+           vector_bytes( m_face_edge ) + m_face_normal.allocated_bytes() + m_face_color.allocated_bytes() +
+           m_vertex_position.allocated_bytes() + m_vertex_color.allocated_bytes() + m_vertex_light.allocated_bytes() +
+           vector_bytes( m_vertex_initialized );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::reset()
+{
+    for( uint32_t vertex = 0; vertex < m_vertex_initialized.size(); ++vertex )
+    {
+        if( m_vertex_initialized[vertex] )
+        {
+            m_vertex_position.set( vertex, vec3( 0.0f, 0.0f, 0.0f ) );
+            m_vertex_color.set( vertex, vec4( 0.0f, 0.0f, 0.0f, 1.0f ) );
+            m_vertex_light.set( vertex, 0.5f );
+            m_vertex_initialized[vertex] = 0;
+            m_free_vertices.push_back( vertex );
+        }
+    }
+
+    for( uint32_t edge = 0; edge < m_edge_vertex.size(); ++edge )
+    {
+        if( m_edge_vertex[edge] != invalid )
+        {
+            m_edge_vertex[edge] = invalid;
+            m_edge_next[edge] = invalid;
+            m_edge_opposing[edge] = invalid;
+            m_edge_face[edge] = invalid;
+            m_free_edges.push_back( edge );
+        }
+    }
+
+    for( uint32_t face = 0; face < m_face_edge.size(); ++face )
+    {
+        if( m_face_edge[face] != invalid )
+        {
+            m_face_edge[face] = invalid;
+            m_free_faces.push_back( face );
+        }
+    }
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::compute_normal( const FaceHandle face )
+{
+    assert( face );
+
+    if( !Traits::FaceNormal::stored ) return;
+
+    const auto e0 = m_face_edge[face.index];
+    const auto e1 = m_edge_next[e0];
+    const auto e2 = m_edge_next[e1];
+
+    const auto & p0 = m_vertex_position[m_edge_vertex[e0]];
+    const auto & p1 = m_vertex_position[m_edge_vertex[e1]];
+    const auto & p2 = m_vertex_position[m_edge_vertex[e2]];
+
+    m_face_normal.set( face.index, glm::normalize( glm::cross( p0 - p1, p0 - p2 ) ) );
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+template<typename Traits>
+void BasicCompactLinkedMesh<Traits>::compute_barycenter( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c, float & u, float & v, float & w )
+{
+    vec3 v0 = b - a, v1 = c - a, v2 = p - a;
+    float d00 = glm::dot( v0, v0 );
+    float d01 = glm::dot( v0, v1 );
+    float d11 = glm::dot( v1, v1 );
+    float d20 = glm::dot( v2, v0 );
+    float d21 = glm::dot( v2, v1 );
+    float denom = d00 * d11 - d01 * d01;
+    v = ( d11 * d20 - d01 * d21 ) / denom;
+    w = ( d00 * d21 - d01 * d20 ) / denom;
+    u = 1.0f - v - w;
+}
+
+template class BasicCompactLinkedMesh<RenderMeshTraits>;
+template class BasicCompactLinkedMesh<CollisionMeshTraits>;
+template class BasicCompactLinkedMesh<QuantizedMeshTraits<16>>;
+template class BasicCompactLinkedMesh<QuantizedMeshTraits<21>>;
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+#include "glm/glm.hpp"
+
+#include "index_handle.hpp"
+#include "mesh_traits.hpp"
+
+/// Halfedge mesh with 32 bit index handles and a structure of arrays layout.
+/// Offers the same editing and export operations as LinkedMesh, but connectivity
+/// (vertex, next, opposing, face) and attributes (position, color, texcoord, normal, light)
+/// live in separate arrays so topology walks only touch the connectivity arrays.
+/// Traits choose which attributes besides the position are stored, see mesh_traits.hpp. Omitted
+/// attributes read their constant fallback and ignore writes through the setters. The member definitions are
+/// instantiated in CompactLinkedMesh.cpp for the traits declared there.
+template<typename Traits>
+class BasicCompactLinkedMesh
+{
+   public:
+
+      struct VertexTag {};
+      struct EdgeTag {};
+      struct FaceTag {};
+
+      typedef IndexHandle<VertexTag> VertexHandle;
+      typedef IndexHandle<EdgeTag> EdgeHandle;
+      typedef IndexHandle<FaceTag> FaceHandle;
+      typedef std::vector<EdgeHandle> EdgeLoop;
+
+      BasicCompactLinkedMesh();
+
+      ~BasicCompactLinkedMesh();
+
+      /// Preallocate storage so building up to this many elements does not allocate
+      void reserve( const size_t vertex_count, const size_t edge_count, const size_t face_count );
+
+      /// Fixed bounds for traits with quantized positions, positions outside are clamped. Without them the
+      /// grid follows the bounds of the vertices added. Call it before the first vertex is added, as it
+      /// encodes the stored positions again. Does nothing for float positions
+      void set_bounds( const vec3 & min, const vec3 & max );
+
+      /// Set the color of every vertex connected to this face
+      void set_color( const FaceHandle face, const vec4 & color );
+
+      /// set the color of a face from face index
+      void set_color( const unsigned int face_index, const vec4 & color );
+
+      /// set the texcoord of a face
+      void set_texcoord( const unsigned int face_index, const std::vector<vec2> & new_texcoords );
+
+      /// Allocate a new vertex
+      VertexHandle add_vertex( const vec3 & position, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Allocate a new halfedge
+      EdgeHandle add_halfedge( const VertexHandle vertex );
+
+      /// Add a new face to the mesh from 3 points and 1 color
+      FaceHandle add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Add a new face to the mesh from 4 points and 1 color
+      FaceHandle add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec3 & p3, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Add a face to the mesh from EdgeHandles of the mesh
+      FaceHandle add_face( EdgeLoop && edges );
+
+      /// Add a face to the mesh from an edgeloop in the mesh
+      FaceHandle add_face( EdgeLoop & edges );
+
+      inline void link_edges( const EdgeHandle edge_left, const EdgeHandle edge_right )
+      {
+         m_edge_opposing[edge_left.index] = edge_right.index;
+         m_edge_opposing[edge_right.index] = edge_left.index;
+      }
+
+      /// bridge two edges by adding two new edges connecting them
+      FaceHandle bridge_edges( const EdgeHandle edge_left, const EdgeHandle edge_right );
+
+      FaceHandle extrude_vertex( const EdgeHandle edge, vec3 offset );
+
+      FaceHandle extrude_edge( const EdgeHandle edge, const vec3 & offset );
+
+      FaceHandle extrude_face( const FaceHandle face, const vec3 & offset );
+
+      /// Fill buffers with mesh points
+      void points( std::vector<float> & position_buffer, std::vector<float> & color_buffer );
+
+      /// compute the normal for this face
+      void compute_normal( const FaceHandle face );
+
+      /// compute barycenter for triangle
+      void compute_barycenter( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c, float & u, float & v, float & w );
+
+      /// Fill mesh vertex buffer
+      void triangles( std::vector<Mesh::Vertex> & vertices );
+
+      /// Fill buffers with mesh faces as triangles
+      void triangles( std::vector<float> & position_buffer, std::vector<float> & color_buffer );
+
+      /// clear vertices, edges and faces; deleting their allocations
+      void clear();
+
+      /// Unlink all vertices, edges and faces. Preparing the mesh for reuse
+      void reset();
+
+      /// connectivity, the handle is invalid where LinkedMesh would hold a nullptr
+      inline VertexHandle vertex( const EdgeHandle edge ) const { return VertexHandle( m_edge_vertex[edge.index] ); }
+      inline EdgeHandle next( const EdgeHandle edge ) const { return EdgeHandle( m_edge_next[edge.index] ); }
+      inline EdgeHandle opposing( const EdgeHandle edge ) const { return EdgeHandle( m_edge_opposing[edge.index] ); }
+      inline FaceHandle face( const EdgeHandle edge ) const { return FaceHandle( m_edge_face[edge.index] ); }
+      inline EdgeHandle edge( const FaceHandle face ) const { return EdgeHandle( m_face_edge[face.index] ); }
+
+      /// attributes, omitted and quantized ones are returned by value
+      inline typename Traits::VertexPosition::const_reference position( const VertexHandle vertex ) const { return m_vertex_position[vertex.index]; }
+      inline typename Traits::VertexColor::const_reference color( const VertexHandle vertex ) const { return m_vertex_color[vertex.index]; }
+      inline typename Traits::VertexLight::const_reference light( const VertexHandle vertex ) const { return m_vertex_light[vertex.index]; }
+      inline typename Traits::EdgeTexcoord::const_reference texcoord( const EdgeHandle edge ) const { return m_edge_texcoord[edge.index]; }
+      inline typename Traits::FaceNormal::const_reference normal( const FaceHandle face ) const { return m_face_normal[face.index]; }
+      inline typename Traits::FaceColor::const_reference color( const FaceHandle face ) const { return m_face_color[face.index]; }
+
+      /// Attributes are written through setters only, so a write can not land in a temporary. Omitted
+      /// attributes drop the value and quantized ones encode it. The face color is set with set_color( face.index, color )
+      inline void set_position( const VertexHandle vertex, const vec3 & position ) { m_vertex_position.set( vertex.index, position ); }
+      inline void set_color( const VertexHandle vertex, const vec4 & color ) { m_vertex_color.set( vertex.index, color ); }
+      inline void set_light( const VertexHandle vertex, const float light ) { m_vertex_light.set( vertex.index, light ); }
+      inline void set_texcoord( const EdgeHandle edge, const vec2 & texcoord ) { m_edge_texcoord.set( edge.index, texcoord ); }
+      inline void set_normal( const FaceHandle face, const vec3 & normal ) { m_face_normal.set( face.index, normal ); }
+
+      inline size_t vertex_count() const { return m_vertex_position.size(); }
+      inline size_t edge_count() const { return m_edge_vertex.size(); }
+      inline size_t face_count() const { return m_face_edge.size(); }
+
+      /// bytes of heap memory held by the element arrays and free lists
+      size_t allocated_bytes() const;
+
+   private:
+
+      static const uint32_t invalid = IndexHandle<VertexTag>::invalid_index;
+
+      /// indices of vertices which were allocated but removed from the mesh and free for reuse
+      std::vector<uint32_t> m_free_vertices;
+
+      /// indices of edges which that were allocated but removed from the mesh and free for reuse
+      std::vector<uint32_t> m_free_edges;
+
+      /// indices of faces which that were allocated but removed from the mesh and free for reuse
+      std::vector<uint32_t> m_free_faces;
+
+      /// halfedge connectivity, invalid marks an unset link
+      std::vector<uint32_t> m_edge_vertex;
+      std::vector<uint32_t> m_edge_next;
+      std::vector<uint32_t> m_edge_opposing;
+      std::vector<uint32_t> m_edge_face;
+
+      /// face connectivity, invalid marks a face on the free list
+      std::vector<uint32_t> m_face_edge;
+
+      /// vertex attributes
+      typename Traits::VertexPosition m_vertex_position;
+      typename Traits::VertexColor m_vertex_color;
+      typename Traits::VertexLight m_vertex_light;
+      std::vector<uint8_t> m_vertex_initialized;
+
+      /// halfedge attributes
+      typename Traits::EdgeTexcoord m_edge_texcoord;
+
+      /// face attributes
+      typename Traits::FaceNormal m_face_normal;
+      typename Traits::FaceColor m_face_color;
+};
+
+typedef BasicCompactLinkedMesh<RenderMeshTraits> CompactLinkedMesh;
+typedef BasicCompactLinkedMesh<CollisionMeshTraits> CollisionLinkedMesh;
+typedef BasicCompactLinkedMesh<QuantizedMeshTraits<21>> QuantizedLinkedMesh;
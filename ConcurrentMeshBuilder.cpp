@@ -0,0 +1,123 @@
+#include "core/mesh/ConcurrentMeshBuilder.hpp"
+#include "core/mesh/make_unique.hpp"
+
+namespace
+{
+    /// smallest share of appended halfedges worth a thread of its own when collecting the frontier
+    const size_t parallel_edges_per_thread = 16384;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+ConcurrentMeshBuilder::ConcurrentMeshBuilder( LinkedMesh & mesh, const unsigned int thread_count, const float weld_epsilon ) :
+    m_mesh( mesh ),
+    m_weld_epsilon( weld_epsilon ),
+    m_revision( 0 ),
+    m_frontier_valid( false )
+{
+    const auto count = thread_count > 0 ? thread_count : std::max( 1u, std::thread::hardware_concurrency() );
+
+    for( unsigned int worker = 0; worker < count; ++worker )
+    {
+        m_meshes.push_back( make_unique<LinkedMesh>() );
+        m_builders.push_back( make_unique<LinkedMeshBuilder>( *m_meshes.back(), weld_epsilon ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+ConcurrentMeshBuilder::~ConcurrentMeshBuilder()
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t ConcurrentMeshBuilder::merge()
+{
+    std::vector<LinkedMesh::EdgeHandle> frontier;
+
+    if( m_frontier_valid && m_mesh.revision() == m_revision )
+    {
+        for( const auto id : m_frontier )
+        {
+            frontier.push_back( m_mesh.edge( id ) );
+        }
+    }
+    else
+    {
+        /// the mesh changed outside of merge, its open halfedges may be anywhere
+        for( size_t i = 0; i < m_mesh.edge_count(); ++i )
+        {
+            const auto edge = m_mesh.edge( i );
+
+            if( edge->initialized && edge->face != nullptr && edge->opposing == nullptr )
+            {
+                frontier.push_back( edge );
+            }
+        }
+    }
+
+    /// append places every worker at the end, so the ranges of the map of all workers start here
+    const auto first_vertex = m_mesh.vertex_count();
+    const auto first_edge = m_mesh.edge_count();
+
+    std::vector<const LinkedMesh *> meshes;
+
+    for( const auto & mesh : m_meshes )
+    {
+        meshes.push_back( mesh.get() );
+    }
+
+    /// every worker is copied into its own id range on its own thread
+    std::vector<LinkedMesh::CompactionMap> maps;
+    m_mesh.append( meshes, maps, thread_count() );
+
+    const auto count = thread_count();
+
+    parallel_for_blocks( count, count, [&]( const unsigned int worker, const size_t, const size_t )
+    {
+        /// the builder refers to the private mesh, renew both so the worker starts empty
+        m_meshes[worker]->clear();
+        m_builders[worker] = make_unique<LinkedMeshBuilder>( *m_meshes[worker], m_weld_epsilon );
+    } );
+
+    /// welding and linking the seams are the only serial part
+    LinkedMeshBuilder stitcher( m_mesh, m_weld_epsilon );
+    const auto linked = stitcher.stitch( frontier, first_vertex, first_edge, count );
+
+    /// halfedges still open are what the next merge stitches to
+    m_frontier.clear();
+
+    for( const auto edge : frontier )
+    {
+        if( edge->opposing == nullptr )
+        {
+            m_frontier.push_back( edge->id );
+        }
+    }
+
+    /// open appended halfedges, gathered per block and joined in order
+    const auto appended = m_mesh.edge_count() - first_edge;
+    const auto threads = parallel_thread_count( appended, count, parallel_edges_per_thread );
+    std::vector<std::vector<uint32_t>> open( threads );
+
+    parallel_for_blocks( appended, threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        for( size_t i = first_edge + begin; i < first_edge + end; ++i )
+        {
+            const auto edge = m_mesh.edge( i );
+
+            if( edge->initialized && edge->face != nullptr && edge->opposing == nullptr )
+            {
+                open[block].push_back( edge->id );
+            }
+        }
+    } );
+
+    for( const auto & ids : open )
+    {
+        m_frontier.insert( m_frontier.end(), ids.begin(), ids.end() );
+    }
+
+    m_revision = m_mesh.revision();
+    m_frontier_valid = true;
+    return linked;
+}
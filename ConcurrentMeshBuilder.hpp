@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+#include "LinkedMeshBuilder.hpp"
+#include "parallel.hpp"
+
+/// Parallel face insertion into one LinkedMesh.
+/// Every worker thread builds into a private mesh through its own LinkedMeshBuilder, so inserting
+/// faces needs no locks and touches no shared state. merge() appends the private meshes to the
+/// target in thread order and stitches the seams between them: coincident vertices of open halfedges
+/// are welded and the halfedges meeting there are linked. The result only depends on what each
+/// worker built, not on thread timing.
+/// merge() allots every worker its own id range in the target and copies and relinks the workers into
+/// their ranges in parallel, one thread per worker. Only the seam stitching is serial; it visits the
+/// open halfedges of the copied elements and the frontier, the open halfedges the previous merge left
+/// in the target. When the target was changed by anything else since, the frontier is found again
+/// with one pass over its halfedges.
+class ConcurrentMeshBuilder
+{
+   public:
+
+      /// thread_count 0 uses every hardware thread, positions closer than weld_epsilon are merged
+      ConcurrentMeshBuilder( LinkedMesh & mesh, const unsigned int thread_count = 0, const float weld_epsilon = 1e-5f );
+
+      ~ConcurrentMeshBuilder();
+
+      inline unsigned int thread_count() const { return static_cast<unsigned int>( m_builders.size() ); }
+
+      /// builder of one worker, it must only be used by one thread at a time
+      inline LinkedMeshBuilder & builder( const unsigned int worker ) { return *m_builders[worker]; }
+
+      /// Call generate( worker, builder ) for every worker, each on its own thread
+      template<typename Generate>
+      void run( Generate generate )
+      {
+         const auto count = thread_count();
+
+         parallel_for_blocks( count, count, [&]( const unsigned int worker, const size_t, const size_t )
+         {
+            generate( worker, *m_builders[worker] );
+         } );
+      }
+
+      /// Move everything the workers built into the mesh and link the halfedges across their seams and
+      /// to the frontier. The workers are empty afterwards and can build again; returns the number of pairs linked
+      size_t merge();
+
+   private:
+
+      LinkedMesh & m_mesh;
+
+      float m_weld_epsilon;
+
+      /// private mesh of every worker
+      std::vector<std::unique_ptr<LinkedMesh>> m_meshes;
+
+      /// builder of every worker, building into its private mesh
+      std::vector<std::unique_ptr<LinkedMeshBuilder>> m_builders;
+
+      /// ids of the open halfedges of the mesh after the last merge
+      std::vector<uint32_t> m_frontier;
+
+      /// revision of the mesh after the last merge, the frontier is only valid while it is unchanged
+      uint64_t m_revision;
+
+      bool m_frontier_valid;
+};
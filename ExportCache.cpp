@@ -0,0 +1,102 @@
+#include "core/mesh/ExportCache.hpp"
+
+/// ////////////////////////////////////////////////////////////////////////////
+ExportCache::ExportCache( LinkedMesh & mesh ) :
+    m_mesh( mesh )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const ExportCache::Flat> ExportCache::flat()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    const auto revision = m_mesh.revision();
+    drop_stale( revision );
+
+    if( !m_flat || m_flat->revision != revision )
+    {
+        auto level = std::make_shared<Flat>();
+        level->revision = revision;
+        m_mesh.triangles( level->vertices );
+
+        m_flat = level;
+    }
+
+    return m_flat;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const ExportCache::Indexed> ExportCache::indexed()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    const auto revision = m_mesh.revision();
+    drop_stale( revision );
+
+    if( !m_indexed || m_indexed->revision != revision )
+    {
+        auto level = std::make_shared<Indexed>();
+        level->revision = revision;
+        m_mesh.triangles_indexed( level->vertices, level->indices );
+
+        m_indexed = level;
+    }
+
+    return m_indexed;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const ExportCache::Indexed> ExportCache::decimated( const size_t target_face_count )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    const auto revision = m_mesh.revision();
+    drop_stale( revision );
+
+    auto & cached = m_decimated[target_face_count];
+
+    if( !cached )
+    {
+        /// decimate a copy, the mesh itself stays as it is
+        LinkedMesh copy;
+        LinkedMesh::CompactionMap map;
+        copy.append( m_mesh, map );
+        copy.decimate( target_face_count );
+
+        auto level = std::make_shared<Indexed>();
+        level->revision = revision;
+        copy.triangles_indexed( level->vertices, level->indices );
+
+        cached = level;
+    }
+
+    return cached;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void ExportCache::clear()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_flat.reset();
+    m_indexed.reset();
+    m_decimated.clear();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void ExportCache::drop_stale( const uint64_t revision )
+{
+    for( auto level = m_decimated.begin(); level != m_decimated.end(); )
+    {
+        if( level->second->revision != revision )
+        {
+            level = m_decimated.erase( level );
+        }
+        else
+        {
+            ++level;
+        }
+    }
+}
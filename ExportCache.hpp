@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+
+/// Triangulated exports of one LinkedMesh, shared by every reader of the mesh.
+/// Each level is built on first use and kept until LinkedMesh::revision() moves on, so readers
+/// asking for an unchanged mesh get the same buffers back instead of triangulating again.
+/// Levels are handed out as shared pointers to immutable buffers: a reader keeps its copy alive
+/// while the cache already holds a newer one. The cache may be used from several threads at once
+/// as long as the mesh is not being edited at the same time.
+class ExportCache
+{
+   public:
+
+      /// triangles( vertices ) output
+      struct Flat
+      {
+         uint64_t revision = 0;
+         std::vector<Mesh::Vertex> vertices;
+      };
+
+      /// triangles_indexed( vertices, indices ) output
+      struct Indexed
+      {
+         uint64_t revision = 0;
+         std::vector<Mesh::Vertex> vertices;
+         std::vector<uint32_t> indices;
+      };
+
+      explicit ExportCache( LinkedMesh & mesh );
+
+      ExportCache( const ExportCache & ) = delete;
+      ExportCache & operator=( const ExportCache & ) = delete;
+
+      /// the mesh as triangles( vertices ) exports it
+      std::shared_ptr<const Flat> flat();
+
+      /// the mesh as triangles_indexed( vertices, indices ) exports it
+      std::shared_ptr<const Indexed> indexed();
+
+      /// Indexed export of a copy of the mesh decimated to at most target_face_count faces, see
+      /// LinkedMesh::decimate. Every target is a level of its own; levels of an older revision are
+      /// dropped the next time any level is asked for
+      std::shared_ptr<const Indexed> decimated( const size_t target_face_count );
+
+      /// drop every level, readers holding one keep it
+      void clear();
+
+   private:
+
+      /// drop the decimated levels of an older revision, m_mutex must be held
+      void drop_stale( const uint64_t revision );
+
+      LinkedMesh & m_mesh;
+
+      /// serializes rebuilds, which export through the non const members of the mesh
+      std::mutex m_mutex;
+
+      std::shared_ptr<const Flat> m_flat;
+      std::shared_ptr<const Indexed> m_indexed;
+
+      /// decimated levels by target face count
+      std::map<size_t, std::shared_ptr<const Indexed>> m_decimated;
+};
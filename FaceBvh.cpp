@@ -0,0 +1,647 @@
+#include "core/mesh/FaceBvh.hpp"
+#include "core/mesh/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /// half the surface area of a box, all the heuristic needs
+    inline float half_area( const vec3 & min, const vec3 & max )
+    {
+        const auto extent = max - min;
+        return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+    }
+
+    /// parameter range [near, far] of the ray inside the box, empty when near > far
+    inline bool intersect_box( const vec3 & min, const vec3 & max, const vec3 & origin, const vec3 & inverse_direction, const float far, float & near )
+    {
+        const auto t0 = ( min - origin ) * inverse_direction;
+        const auto t1 = ( max - origin ) * inverse_direction;
+        const auto t_near = glm::min( t0, t1 );
+        const auto t_far = glm::max( t0, t1 );
+
+        near = std::max( std::max( t_near[0], t_near[1] ), std::max( t_near[2], 0.0f ) );
+        return near <= std::min( std::min( t_far[0], t_far[1] ), std::min( t_far[2], far ) );
+    }
+
+    /// squared distance from point to the box, 0 inside
+    inline float box_distance_squared( const vec3 & min, const vec3 & max, const vec3 & point )
+    {
+        const auto outside = glm::max( glm::max( min - point, point - max ), vec3( 0.0f ) );
+        return glm::dot( outside, outside );
+    }
+
+    /// Moller-Trumbore, the ray parameter of the hit or a negative value
+    inline float intersect_triangle( const vec3 & origin, const vec3 & direction, const vec3 & a, const vec3 & b, const vec3 & c )
+    {
+        const auto ab = b - a;
+        const auto ac = c - a;
+        const auto p = glm::cross( direction, ac );
+        const auto determinant = glm::dot( ab, p );
+
+        if( std::fabs( determinant ) < std::numeric_limits<float>::min() )
+        {
+            return -1.0f;
+        }
+
+        const auto inverse = 1.0f / determinant;
+        const auto s = origin - a;
+        const auto u = glm::dot( s, p ) * inverse;
+
+        if( u < 0.0f || u > 1.0f )
+        {
+            return -1.0f;
+        }
+
+        const auto q = glm::cross( s, ab );
+        const auto v = glm::dot( direction, q ) * inverse;
+
+        if( v < 0.0f || u + v > 1.0f )
+        {
+            return -1.0f;
+        }
+
+        return glm::dot( ac, q ) * inverse;
+    }
+
+    /// nearest point to p on the triangle a, b, c by its Voronoi regions
+    vec3 closest_on_triangle( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c )
+    {
+        const auto ab = b - a;
+        const auto ac = c - a;
+        const auto ap = p - a;
+        const auto d1 = glm::dot( ab, ap );
+        const auto d2 = glm::dot( ac, ap );
+
+        if( d1 <= 0.0f && d2 <= 0.0f ) return a;
+
+        const auto bp = p - b;
+        const auto d3 = glm::dot( ab, bp );
+        const auto d4 = glm::dot( ac, bp );
+
+        if( d3 >= 0.0f && d4 <= d3 ) return b;
+
+        const auto vc = d1 * d4 - d3 * d2;
+
+        if( vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f ) return a + ab * ( d1 / ( d1 - d3 ) );
+
+        const auto cp = p - c;
+        const auto d5 = glm::dot( ab, cp );
+        const auto d6 = glm::dot( ac, cp );
+
+        if( d6 >= 0.0f && d5 <= d6 ) return c;
+
+        const auto vb = d5 * d2 - d1 * d6;
+
+        if( vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f ) return a + ac * ( d2 / ( d2 - d6 ) );
+
+        const auto va = d3 * d6 - d5 * d4;
+
+        if( va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f ) return b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+
+        const auto denominator = 1.0f / ( va + vb + vc );
+        return a + ab * ( vb * denominator ) + ac * ( vc * denominator );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+FaceBvh::FaceBvh( LinkedMesh & mesh ) :
+    m_mesh( mesh )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+FaceBvh::Bounds FaceBvh::face_bounds( const FaceHandle face ) const
+{
+    Bounds bounds = { face->edge->vertex->position, face->edge->vertex->position };
+
+    for( const auto edge : m_mesh.edges( face ) )
+    {
+        bounds.min = glm::min( bounds.min, edge->vertex->position );
+        bounds.max = glm::max( bounds.max, edge->vertex->position );
+    }
+
+    return bounds;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void FaceBvh::build( const unsigned int thread_count )
+{
+    m_nodes.clear();
+    m_faces.clear();
+
+    for( size_t i = 0; i < m_mesh.face_count(); ++i )
+    {
+        const auto face = m_mesh.face( i );
+
+        if( face->initialized && face->edge != nullptr )
+        {
+            m_faces.push_back( static_cast<uint32_t>( i ) );
+        }
+    }
+
+    if( m_faces.empty() )
+    {
+        return;
+    }
+
+    const auto threads = parallel_thread_count( m_faces.size(), thread_count, parallel_faces_per_task );
+
+    m_face_bounds.resize( m_mesh.face_count() );
+    m_centroids.resize( m_mesh.face_count() );
+
+    parallel_for_blocks( m_faces.size(), threads, [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            const auto id = m_faces[i];
+            const auto bounds = face_bounds( m_mesh.face( id ) );
+
+            m_face_bounds[id] = bounds;
+            m_centroids[id] = ( bounds.min + bounds.max ) * 0.5f;
+        }
+    } );
+
+    const auto count = static_cast<uint32_t>( m_faces.size() );
+    m_nodes.reserve( 2 * ( count / leaf_faces + 1 ) );
+    m_nodes.push_back( Node() );
+
+    if( threads <= 1 )
+    {
+        build_node( m_nodes, 0, 0, count, 0, nullptr, 0 );
+        return;
+    }
+
+    /// split the top of the tree here, leaving subtrees of about a quarter thread worth of faces
+    std::vector<BuildTask> tasks;
+    const auto defer_size = std::max( size_t( parallel_faces_per_task ), m_faces.size() / ( threads * 4 ) );
+    build_node( m_nodes, 0, 0, count, 0, &tasks, defer_size );
+
+    /// the subtrees cover disjoint ranges of m_faces, every one is built into nodes of its own
+    std::vector<std::vector<Node>> subtrees( tasks.size() );
+
+    parallel_for_blocks( tasks.size(), std::min<unsigned int>( threads, static_cast<unsigned int>( tasks.size() ) ), [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            const auto & task = tasks[i];
+
+            subtrees[i].reserve( 2 * ( ( task.end - task.begin ) / leaf_faces + 1 ) );
+            subtrees[i].push_back( Node() );
+            build_node( subtrees[i], 0, task.begin, task.end, task.depth, nullptr, 0 );
+        }
+    } );
+
+    /// splice the subtrees in, their root replaces the placeholder and the rest is appended
+    for( size_t i = 0; i < tasks.size(); ++i )
+    {
+        const auto & subtree = subtrees[i];
+        const auto base = static_cast<uint32_t>( m_nodes.size() ) - 1;
+
+        auto relocate = [base]( Node node )
+        {
+            if( node.count == 0 )
+            {
+                node.index += base;
+            }
+
+            return node;
+        };
+
+        m_nodes[tasks[i].node] = relocate( subtree[0] );
+
+        for( size_t k = 1; k < subtree.size(); ++k )
+        {
+            m_nodes.push_back( relocate( subtree[k] ) );
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void FaceBvh::build_node( std::vector<Node> & nodes, const uint32_t node, const uint32_t begin, const uint32_t end, const uint32_t depth,
+                          std::vector<BuildTask> * deferred, const size_t defer_size )
+{
+    const auto count = end - begin;
+
+    if( deferred != nullptr && count <= defer_size )
+    {
+        deferred->push_back( { node, begin, end, depth } );
+        return;
+    }
+
+    Bounds bounds = m_face_bounds[m_faces[begin]];
+    Bounds centroid_bounds = { m_centroids[m_faces[begin]], m_centroids[m_faces[begin]] };
+
+    for( auto i = begin + 1; i < end; ++i )
+    {
+        const auto id = m_faces[i];
+
+        bounds.min = glm::min( bounds.min, m_face_bounds[id].min );
+        bounds.max = glm::max( bounds.max, m_face_bounds[id].max );
+        centroid_bounds.min = glm::min( centroid_bounds.min, m_centroids[id] );
+        centroid_bounds.max = glm::max( centroid_bounds.max, m_centroids[id] );
+    }
+
+    nodes[node].min = bounds.min;
+    nodes[node].max = bounds.max;
+
+    auto make_leaf = [&]()
+    {
+        nodes[node].index = begin;
+        nodes[node].count = count;
+    };
+
+    if( count <= leaf_faces )
+    {
+        make_leaf();
+        return;
+    }
+
+    const auto extent = centroid_bounds.max - centroid_bounds.min;
+
+    /// best split of the binned heuristic: axis and first bin of the right side
+    int best_axis = -1;
+    uint32_t best_bin = 0;
+    float best_cost = std::numeric_limits<float>::max();
+
+    if( depth < max_sah_depth )
+    {
+        for( int axis = 0; axis < 3; ++axis )
+        {
+            if( !( extent[axis] > 0.0f ) ) continue;
+
+            const auto scale = bin_count / extent[axis];
+
+            struct Bin
+            {
+                Bounds bounds;
+                uint32_t count;
+            };
+
+            Bin bins[bin_count];
+
+            for( auto & bin : bins )
+            {
+                bin.bounds = { vec3( std::numeric_limits<float>::max() ), vec3( -std::numeric_limits<float>::max() ) };
+                bin.count = 0;
+            }
+
+            for( auto i = begin; i < end; ++i )
+            {
+                const auto id = m_faces[i];
+                const auto index = std::min<uint32_t>( bin_count - 1, static_cast<uint32_t>( ( m_centroids[id][axis] - centroid_bounds.min[axis] ) * scale ) );
+
+                bins[index].bounds.min = glm::min( bins[index].bounds.min, m_face_bounds[id].min );
+                bins[index].bounds.max = glm::max( bins[index].bounds.max, m_face_bounds[id].max );
+                ++bins[index].count;
+            }
+
+            /// cost of the right side of every split, swept from the last bin
+            float right_cost[bin_count];
+            Bounds right = bins[bin_count - 1].bounds;
+            uint32_t right_count = 0;
+
+            for( auto i = bin_count - 1; i > 0; --i )
+            {
+                right.min = glm::min( right.min, bins[i].bounds.min );
+                right.max = glm::max( right.max, bins[i].bounds.max );
+                right_count += bins[i].count;
+                right_cost[i] = right_count > 0 ? half_area( right.min, right.max ) * right_count : 0.0f;
+            }
+
+            Bounds left = bins[0].bounds;
+            uint32_t left_count = 0;
+
+            for( uint32_t i = 1; i < bin_count; ++i )
+            {
+                left.min = glm::min( left.min, bins[i - 1].bounds.min );
+                left.max = glm::max( left.max, bins[i - 1].bounds.max );
+                left_count += bins[i - 1].count;
+
+                if( left_count == 0 || left_count == count ) continue;
+
+                const auto cost = half_area( left.min, left.max ) * left_count + right_cost[i];
+
+                if( cost < best_cost )
+                {
+                    best_axis = axis;
+                    best_bin = i;
+                    best_cost = cost;
+                }
+            }
+        }
+
+        /// a leaf is cheaper when intersecting all of its faces costs less than traversing into children
+        const auto area = half_area( bounds.min, bounds.max );
+
+        if( count <= max_leaf_faces && ( best_axis < 0 || best_cost >= area * ( count - 1 ) ) )
+        {
+            make_leaf();
+            return;
+        }
+    }
+
+    auto first = m_faces.begin() + begin;
+    auto last = m_faces.begin() + end;
+    auto middle = first;
+
+    if( best_axis >= 0 )
+    {
+        const auto axis = best_axis;
+        const auto scale = bin_count / extent[axis];
+        const auto minimum = centroid_bounds.min[axis];
+        const auto split = best_bin;
+
+        middle = std::partition( first, last, [&]( const uint32_t id )
+        {
+            return std::min<uint32_t>( bin_count - 1, static_cast<uint32_t>( ( m_centroids[id][axis] - minimum ) * scale ) ) < split;
+        } );
+    }
+
+    if( middle == first || middle == last )
+    {
+        /// coincident centroids or too deep for the heuristic: split at the median of the widest axis
+        const auto axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : extent[1] >= extent[2] ? 1 : 2;
+        middle = first + count / 2;
+
+        std::nth_element( first, middle, last, [&]( const uint32_t left, const uint32_t right )
+        {
+            return m_centroids[left][axis] < m_centroids[right][axis];
+        } );
+    }
+
+    const auto split = static_cast<uint32_t>( middle - m_faces.begin() );
+    const auto children = static_cast<uint32_t>( nodes.size() );
+
+    nodes[node].index = children;
+    nodes[node].count = 0;
+    nodes.push_back( Node() );
+    nodes.push_back( Node() );
+
+    build_node( nodes, children, begin, split, depth + 1, deferred, defer_size );
+    build_node( nodes, children + 1, split, end, depth + 1, deferred, defer_size );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void FaceBvh::refit( const unsigned int thread_count )
+{
+    if( m_nodes.empty() )
+    {
+        return;
+    }
+
+    const auto threads = parallel_thread_count( m_faces.size(), thread_count, parallel_faces_per_task );
+
+    parallel_for_blocks( m_nodes.size(), threads, [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            auto & node = m_nodes[i];
+
+            if( node.count == 0 ) continue;
+
+            Bounds bounds = face_bounds( m_mesh.face( m_faces[node.index] ) );
+
+            for( auto k = node.index + 1; k < node.index + node.count; ++k )
+            {
+                const auto other = face_bounds( m_mesh.face( m_faces[k] ) );
+
+                bounds.min = glm::min( bounds.min, other.min );
+                bounds.max = glm::max( bounds.max, other.max );
+            }
+
+            node.min = bounds.min;
+            node.max = bounds.max;
+        }
+    } );
+
+    /// children follow their parent, so walking backwards finishes them first
+    for( size_t i = m_nodes.size(); i-- > 0; )
+    {
+        auto & node = m_nodes[i];
+
+        if( node.count != 0 ) continue;
+
+        const auto & left = m_nodes[node.index];
+        const auto & right = m_nodes[node.index + 1];
+
+        node.min = glm::min( left.min, right.min );
+        node.max = glm::max( left.max, right.max );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool FaceBvh::raycast( const vec3 & origin, const vec3 & direction, RayHit & hit, const float max_distance ) const
+{
+    if( m_nodes.empty() )
+    {
+        return false;
+    }
+
+    const auto inverse_direction = vec3( 1.0f ) / direction;
+
+    float best = max_distance;
+    FaceHandle best_face = nullptr;
+    EdgeHandle best_corners[3] = { nullptr, nullptr, nullptr };
+
+    uint32_t stack[traversal_stack_size];
+    uint32_t size = 0;
+    float near;
+
+    if( !intersect_box( m_nodes[0].min, m_nodes[0].max, origin, inverse_direction, best, near ) )
+    {
+        return false;
+    }
+
+    stack[size++] = 0;
+
+    while( size > 0 )
+    {
+        const auto & node = m_nodes[stack[--size]];
+
+        if( node.count == 0 )
+        {
+            /// push the farther child first so the nearer one is visited next
+            const auto left = node.index;
+            const auto right = node.index + 1;
+            float near_left, near_right;
+            const auto hit_left = intersect_box( m_nodes[left].min, m_nodes[left].max, origin, inverse_direction, best, near_left );
+            const auto hit_right = intersect_box( m_nodes[right].min, m_nodes[right].max, origin, inverse_direction, best, near_right );
+
+            if( hit_left && hit_right )
+            {
+                const auto near_first = near_left <= near_right;
+                stack[size++] = near_first ? right : left;
+                stack[size++] = near_first ? left : right;
+            }
+            else if( hit_left )
+            {
+                stack[size++] = left;
+            }
+            else if( hit_right )
+            {
+                stack[size++] = right;
+            }
+
+            continue;
+        }
+
+        if( !intersect_box( node.min, node.max, origin, inverse_direction, best, near ) ) continue;
+
+        for( auto i = node.index; i < node.index + node.count; ++i )
+        {
+            const auto face = m_mesh.face( m_faces[i] );
+            const auto first = face->edge;
+
+            /// fan around the first corner, as triangles() emits it
+            for( auto edge = first->next; edge->next != first; edge = edge->next )
+            {
+                const auto t = intersect_triangle( origin, direction, first->vertex->position, edge->vertex->position, edge->next->vertex->position );
+
+                if( t >= 0.0f && t < best )
+                {
+                    best = t;
+                    best_face = face;
+                    best_corners[0] = first;
+                    best_corners[1] = edge;
+                    best_corners[2] = edge->next;
+                }
+            }
+        }
+    }
+
+    if( best_face == nullptr )
+    {
+        return false;
+    }
+
+    hit.face = best_face;
+    hit.distance = best;
+    std::copy( best_corners, best_corners + 3, hit.corners );
+
+    m_mesh.compute_barycenter( origin + direction * best, best_corners[0]->vertex->position, best_corners[1]->vertex->position,
+                               best_corners[2]->vertex->position, hit.u, hit.v, hit.w );
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool FaceBvh::closest_point( const vec3 & point, ClosestPoint & result, const float max_distance ) const
+{
+    if( m_nodes.empty() )
+    {
+        return false;
+    }
+
+    const auto limit = max_distance < std::sqrt( std::numeric_limits<float>::max() ) ? max_distance * max_distance : std::numeric_limits<float>::max();
+
+    float best = limit;
+    FaceHandle best_face = nullptr;
+    vec3 best_point;
+
+    uint32_t stack[traversal_stack_size];
+    uint32_t size = 0;
+
+    stack[size++] = 0;
+
+    while( size > 0 )
+    {
+        const auto & node = m_nodes[stack[--size]];
+
+        if( box_distance_squared( node.min, node.max, point ) > best ) continue;
+
+        if( node.count == 0 )
+        {
+            /// visit the nearer child first, it tightens the bound for the other one
+            const auto left = node.index;
+            const auto right = node.index + 1;
+            const auto distance_left = box_distance_squared( m_nodes[left].min, m_nodes[left].max, point );
+            const auto distance_right = box_distance_squared( m_nodes[right].min, m_nodes[right].max, point );
+            const auto near_first = distance_left <= distance_right;
+
+            stack[size++] = near_first ? right : left;
+            stack[size++] = near_first ? left : right;
+            continue;
+        }
+
+        for( auto i = node.index; i < node.index + node.count; ++i )
+        {
+            const auto face = m_mesh.face( m_faces[i] );
+            const auto first = face->edge;
+
+            for( auto edge = first->next; edge->next != first; edge = edge->next )
+            {
+                const auto candidate = closest_on_triangle( point, first->vertex->position, edge->vertex->position, edge->next->vertex->position );
+                const auto offset = candidate - point;
+                const auto distance = glm::dot( offset, offset );
+
+                if( distance <= best )
+                {
+                    best = distance;
+                    best_face = face;
+                    best_point = candidate;
+                }
+            }
+        }
+    }
+
+    if( best_face == nullptr )
+    {
+        return false;
+    }
+
+    result.face = best_face;
+    result.point = best_point;
+    result.distance = std::sqrt( best );
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t FaceBvh::overlap( const vec3 & min, const vec3 & max, std::vector<FaceHandle> & faces ) const
+{
+    const auto first_face = faces.size();
+
+    if( m_nodes.empty() )
+    {
+        return 0;
+    }
+
+    auto overlaps = [&]( const vec3 & node_min, const vec3 & node_max )
+    {
+        return node_min[0] <= max[0] && node_min[1] <= max[1] && node_min[2] <= max[2] &&
+               min[0] <= node_max[0] && min[1] <= node_max[1] && min[2] <= node_max[2];
+    };
+
+    uint32_t stack[traversal_stack_size];
+    uint32_t size = 0;
+
+    stack[size++] = 0;
+
+    while( size > 0 )
+    {
+        const auto & node = m_nodes[stack[--size]];
+
+        if( !overlaps( node.min, node.max ) ) continue;
+
+        if( node.count == 0 )
+        {
+            stack[size++] = node.index + 1;
+            stack[size++] = node.index;
+            continue;
+        }
+
+        for( auto i = node.index; i < node.index + node.count; ++i )
+        {
+            const auto face = m_mesh.face( m_faces[i] );
+            const auto bounds = face_bounds( face );
+
+            if( overlaps( bounds.min, bounds.max ) )
+            {
+                faces.push_back( face );
+            }
+        }
+    }
+
+    return faces.size() - first_face;
+}
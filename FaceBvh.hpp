@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+
+/// Bounding volume hierarchy over the faces of a LinkedMesh for picking and proximity queries.
+/// Nodes are split by a binned surface area heuristic; large meshes build their subtrees on several
+/// threads. After vertices move, refit() updates the bounds in place without changing the tree, as long
+/// as no face was added or removed. Faces with more than three corners are handled as the same fan of
+/// triangles that triangles() emits.
+class FaceBvh
+{
+   public:
+
+      typedef LinkedMesh::VertexHandle VertexHandle;
+      typedef LinkedMesh::EdgeHandle EdgeHandle;
+      typedef LinkedMesh::FaceHandle FaceHandle;
+
+      /// nearest face along a ray
+      struct RayHit
+      {
+         FaceHandle face = nullptr;
+
+         /// corners of the triangle that was hit, the face edges starting at them
+         EdgeHandle corners[3];
+
+         /// ray parameter of the hit, origin + direction * distance
+         float distance = 0.0f;
+
+         /// barycentric weights of corners[0], corners[1] and corners[2], from LinkedMesh::compute_barycenter
+         float u = 0.0f;
+         float v = 0.0f;
+         float w = 0.0f;
+      };
+
+      /// face nearest to a point
+      struct ClosestPoint
+      {
+         FaceHandle face = nullptr;
+
+         /// nearest point on the face
+         vec3 point;
+
+         float distance = 0.0f;
+      };
+
+      explicit FaceBvh( LinkedMesh & mesh );
+
+      /// Build the tree over the live faces of the mesh on thread_count threads (0 uses every hardware thread)
+      void build( const unsigned int thread_count = 0 );
+
+      /// Recompute the bounds of every node after vertices moved. The faces must be the ones the tree was built over
+      void refit( const unsigned int thread_count = 0 );
+
+      /// Nearest face hit by the ray within max_distance, direction does not need to be normalized.
+      /// Returns false when nothing is hit
+      bool raycast( const vec3 & origin, const vec3 & direction, RayHit & hit, const float max_distance = std::numeric_limits<float>::max() ) const;
+
+      /// Face nearest to point within max_distance, returns false when there is none
+      bool closest_point( const vec3 & point, ClosestPoint & result, const float max_distance = std::numeric_limits<float>::max() ) const;
+
+      /// Append every face whose bounds overlap the box min, max to faces, returns the number appended
+      size_t overlap( const vec3 & min, const vec3 & max, std::vector<FaceHandle> & faces ) const;
+
+      inline bool empty() const { return m_nodes.empty(); }
+      inline size_t node_count() const { return m_nodes.size(); }
+      inline size_t face_count() const { return m_faces.size(); }
+
+   private:
+
+      struct Bounds
+      {
+         vec3 min;
+         vec3 max;
+      };
+
+      /// a leaf holds count faces from m_faces[index], an inner node has count 0 and its children
+      /// at index and index + 1. Children are always stored after their parent
+      struct Node
+      {
+         vec3 min;
+         uint32_t index;
+         vec3 max;
+         uint32_t count;
+      };
+
+      /// a subtree left to a worker thread
+      struct BuildTask
+      {
+         uint32_t node;
+         uint32_t begin;
+         uint32_t end;
+         uint32_t depth;
+      };
+
+      /// faces a leaf is made of without asking the heuristic
+      static const uint32_t leaf_faces = 4;
+
+      /// most faces the heuristic may leave in a leaf
+      static const uint32_t max_leaf_faces = 16;
+
+      /// centroid bins per axis
+      static const uint32_t bin_count = 12;
+
+      /// deeper nodes are split at the median, which keeps the depth below traversal_stack_size
+      static const uint32_t max_sah_depth = 64;
+      static const uint32_t traversal_stack_size = 128;
+
+      /// smallest subtree worth a thread of its own
+      static const size_t parallel_faces_per_task = 16384;
+
+      /// Build the subtree of nodes[node] over m_faces[begin, end). Subtrees of at most defer_size faces
+      /// are pushed to deferred instead when it is not null
+      void build_node( std::vector<Node> & nodes, const uint32_t node, const uint32_t begin, const uint32_t end, const uint32_t depth,
+                       std::vector<BuildTask> * deferred, const size_t defer_size );
+
+      /// bounds of one face from its corners
+      Bounds face_bounds( const FaceHandle face ) const;
+
+      LinkedMesh & m_mesh;
+
+      std::vector<Node> m_nodes;
+
+      /// face ids in leaf order
+      std::vector<uint32_t> m_faces;
+
+      /// build scratch by face id, kept so rebuilding does not allocate
+      std::vector<Bounds> m_face_bounds;
+      std::vector<vec3> m_centroids;
+};
@@ -1,7 +1,56 @@
 #include "core/mesh/LinkedMesh.hpp"
+#include "core/mesh/mesh_kernels.hpp"
+#include "core/mesh/ExportCache.hpp"
+#include "core/mesh/make_unique.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+const uint32_t LinkedMesh::CompactionMap::removed;
+const uint64_t LinkedMesh::ChangeLog::stopped;
+
+namespace
+{
+    /// number the initialized elements of pool in their current order, returns their count
+    template<typename Pool>
+    uint32_t number_live_elements( const Pool & pool, std::vector<uint32_t> & indices )
+    {
+        uint32_t count = 0;
+        indices.assign( pool.size(), LinkedMesh::CompactionMap::removed );
+
+        for( size_t i = 0; i < pool.size(); ++i )
+        {
+            if( pool[i].initialized )
+            {
+                indices[i] = count++;
+            }
+        }
+
+        return count;
+    }
+
+    /// move the live indices of a map numbered from 0 to start at base
+    inline void rebase_indices( std::vector<uint32_t> & indices, const uint32_t base )
+    {
+        for( auto & index : indices )
+        {
+            if( index != LinkedMesh::CompactionMap::removed )
+            {
+                index += base;
+            }
+        }
+    }
+
+    template<typename T>
+    inline size_t vector_bytes( const std::vector<T> & vector )
+    {
+        return vector.capacity() * sizeof( T );
+    }
+}
 
 /// ////////////////////////////////////////////////////////////////////////////
-LinkedMesh::LinkedMesh()
+LinkedMesh::LinkedMesh() :
+    m_export_cache( make_unique<ExportCache>( *this ) )
 {
 
 }
@@ -12,9 +61,19 @@ LinkedMesh::~LinkedMesh()
 
 }
 
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::reserve( const size_t vertex_count, const size_t edge_count, const size_t face_count )
+{
+    m_vertices.reserve( vertex_count );
+    m_edges.reserve( edge_count );
+    m_faces.reserve( face_count );
+}
+
 /// ////////////////////////////////////////////////////////////////////////////
 void LinkedMesh::set_color( const FaceHandle face, const glm::vec4 & color )
 {
+    touch_attributes_logged();
+
     const auto first_edge = face->edge;
     auto edge = first_edge;
 
@@ -23,6 +82,8 @@ void LinkedMesh::set_color( const FaceHandle face, const glm::vec4 & color )
     do
     {
         edge->vertex->color = color;
+        log_vertex( edge->vertex->id );
+        queue_dirty_vertex( edge->vertex );
     }
     while( ( edge = edge->next ) != first_edge );
 }
@@ -30,15 +91,21 @@ void LinkedMesh::set_color( const FaceHandle face, const glm::vec4 & color )
 /// ////////////////////////////////////////////////////////////////////////////
 void LinkedMesh::set_color( const unsigned int face_index, const vec4 & color )
 {
+    touch_attributes_logged();
+
     assert( face_index < m_faces.size() );
-    m_faces[face_index]->color = color;
+    m_faces[face_index].color = color;
+    log_face( face_index );
+    queue_dirty( &m_faces[face_index] );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 void LinkedMesh::set_texcoord( const unsigned int face_index, const std::vector<vec2> & new_texcoords )
 {
+    touch_attributes_logged();
+
     assert( face_index < m_faces.size() );
-    const auto first_edge = m_faces[face_index]->edge;
+    const auto first_edge = m_faces[face_index].edge;
     auto edge = first_edge;
 
     int edge_count = 0;
@@ -46,33 +113,41 @@ void LinkedMesh::set_texcoord( const unsigned int face_index, const std::vector<
     do
     {
         edge->texcoord = new_texcoords[edge_count++];
+        log_edge( edge->id );
     }
     while( ( edge = edge->next ) != first_edge );
 
     /// make sure the face has exactly as many vertices as new_texcoords were passed in
     assert( edge_count == new_texcoords.size() );
+
+    queue_dirty( &m_faces[face_index] );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::VertexHandle LinkedMesh::add_vertex( const vec3 & position, const vec4 & color )
 {
+    touch_logged();
+
     VertexHandle new_vertex;
 
     if( !m_free_vertices.empty() )
     {
-        new_vertex = m_vertices[m_free_vertices.back()].get();
+        new_vertex = &m_vertices[m_free_vertices.back()];
         m_free_vertices.pop_back();
+        m_change_log.kept_free_vertices = std::min( m_change_log.kept_free_vertices, m_free_vertices.size() );
         new_vertex->position = position;
         new_vertex->color = color;
+        LINKEDMESH_STATS_HIT( m_stats.vertices );
     }
     else
     {
-        m_vertices.emplace_back( make_unique<Vertex>( m_vertices.size(), position, color ) );
-        new_vertex = m_vertices.back().get();
+        new_vertex = &m_vertices.emplace_back( m_vertices.size(), position, color );
+        LINKEDMESH_STATS_MISS( m_stats.vertices );
     }
 
     assert( new_vertex->initialized == false );
     new_vertex->initialized = true;
+    log_vertex( new_vertex->id );
 
     return new_vertex;
 }
@@ -80,23 +155,28 @@ LinkedMesh::VertexHandle LinkedMesh::add_vertex( const vec3 & position, const ve
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::EdgeHandle LinkedMesh::add_halfedge( const VertexHandle vertex )
 {
+    touch_logged();
+
     EdgeHandle new_edge;
     if( !m_free_edges.empty() )
     {
         /// use a free edge if possible
-        new_edge = m_edges[m_free_edges.back()].get();
+        new_edge = &m_edges[m_free_edges.back()];
         m_free_edges.pop_back();
+        m_change_log.kept_free_edges = std::min( m_change_log.kept_free_edges, m_free_edges.size() );
         new_edge->vertex = vertex;
+        LINKEDMESH_STATS_HIT( m_stats.edges );
     }
     else
     {
         /// otherwise allocate a new edge
-        m_edges.emplace_back( make_unique<Edge>( m_edges.size(), vertex ) );
-        new_edge = m_edges.back().get();
+        new_edge = &m_edges.emplace_back( m_edges.size(), vertex );
+        LINKEDMESH_STATS_MISS( m_stats.edges );
     }
 
     assert( new_edge->initialized == false );
     new_edge->initialized = true;
+    log_edge( new_edge->id );
 
     return new_edge;
 }
@@ -104,22 +184,28 @@ LinkedMesh::EdgeHandle LinkedMesh::add_halfedge( const VertexHandle vertex )
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec4 & color )
 {
-    EdgeLoop edge_loop;
-    edge_loop.emplace_back( add_halfedge( add_vertex( p0, color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( p1, color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( p2, color ) ) );
-    return add_face( edge_loop );
+    const EdgeHandle edge_loop[] =
+    {
+        add_halfedge( add_vertex( p0, color ) ),
+        add_halfedge( add_vertex( p1, color ) ),
+        add_halfedge( add_vertex( p2, color ) )
+    };
+
+    return add_face( edge_loop, 3 );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec3 & p3, const vec4 & color )
 {
-    EdgeLoop edge_loop;
-    edge_loop.emplace_back( add_halfedge( add_vertex( p0, color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( p1, color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( p2, color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( p3, color ) ) );
-    return add_face( edge_loop );
+    const EdgeHandle edge_loop[] =
+    {
+        add_halfedge( add_vertex( p0, color ) ),
+        add_halfedge( add_vertex( p1, color ) ),
+        add_halfedge( add_vertex( p2, color ) ),
+        add_halfedge( add_vertex( p3, color ) )
+    };
+
+    return add_face( edge_loop, 4 );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
@@ -131,31 +217,45 @@ LinkedMesh::FaceHandle LinkedMesh::add_face( EdgeLoop && edges )
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::add_face( EdgeLoop & edges )
 {
-    assert( edges.size() > 2 );
+    return add_face( edges.data(), edges.size() );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMesh::FaceHandle LinkedMesh::add_face( const EdgeHandle * edges, const size_t count )
+{
+    touch_logged();
+
+    assert( count > 2 );
 
     FaceHandle new_face;
 
     if( !m_free_faces.empty() )
     {
         /// if there is a free face on the stack reuse it
-        new_face = m_faces[m_free_faces.back()].get();
+        new_face = &m_faces[m_free_faces.back()];
         //assert( new_face->edge == nullptr );
-        //assert( edges.front() != nullptr );
-        new_face->edge = edges.front();
+        //assert( edges[0] != nullptr );
+        new_face->edge = edges[0];
         m_free_faces.pop_back();
+        m_change_log.kept_free_faces = std::min( m_change_log.kept_free_faces, m_free_faces.size() );
+
+        /// the face fills a gap in the last export, its output can not be appended
+        m_export_layout_valid = false;
+        LINKEDMESH_STATS_HIT( m_stats.faces );
     }
     else
     {
         /// when there is no free faces stacked allocate a new
-        m_faces.emplace_back( make_unique<Face>( m_faces.size(), edges.front() ) );
-        new_face = m_faces.back().get();
+        new_face = &m_faces.emplace_back( m_faces.size(), edges[0] );
+        LINKEDMESH_STATS_MISS( m_stats.faces );
     }
 
     assert( new_face->initialized == false );
     new_face->initialized = true;
+    log_face( new_face->id );
 
     /// make edgeloop
-    for( unsigned int i = 0; i < edges.size(); ++i )
+    for( unsigned int i = 0; i < count; ++i )
     {
         if( edges[i]->next != nullptr )
         {
@@ -165,8 +265,15 @@ LinkedMesh::FaceHandle LinkedMesh::add_face( EdgeLoop & edges )
 
         //assert( edges[i]->next == nullptr );
 
-        edges[i]->next = edges[( i+1 )%edges.size()];
+        edges[i]->next = edges[( i+1 )%count];
         edges[i]->face = new_face;
+        log_edge( edges[i]->id );
+
+        if( edges[i]->vertex->edge == nullptr )
+        {
+            edges[i]->vertex->edge = edges[i];
+            log_vertex( edges[i]->vertex->id );
+        }
         switch( i )
         {
         case 0:
@@ -215,7 +322,8 @@ LinkedMesh::FaceHandle LinkedMesh::bridge_edges( const EdgeHandle edge_left, con
     assert( edge_left->next && edge_right->next );
     assert( edge_left->opposing == nullptr && edge_right->opposing == nullptr );
 
-    std::vector<EdgeHandle> edge_loop;
+    EdgeHandle edge_loop[4];
+    size_t count = 0;
 
     VertexHandle vertex[] =
     {
@@ -245,25 +353,27 @@ LinkedMesh::FaceHandle LinkedMesh::bridge_edges( const EdgeHandle edge_left, con
     }
     else
     {
-        edge_loop.emplace_back( add_halfedge( vertex[1] ) );
-        link_edges( edge_loop.back(), edge_left );
-        edge_loop.emplace_back( add_halfedge( vertex[0] ) );
+        edge_loop[count++] = add_halfedge( vertex[1] );
+        link_edges( edge_loop[count - 1], edge_left );
+        edge_loop[count++] = add_halfedge( vertex[0] );
         if( vertex[0] != vertex[3] )
         {
-            edge_loop.emplace_back( add_halfedge( vertex[3] ) );
+            edge_loop[count++] = add_halfedge( vertex[3] );
         }
-        link_edges( edge_loop.back(), edge_right );
+        link_edges( edge_loop[count - 1], edge_right );
         if( vertex[1] != vertex[2] )
         {
-            edge_loop.emplace_back( add_halfedge( vertex[2] ) );
+            edge_loop[count++] = add_halfedge( vertex[2] );
         }
     }
-    return add_face( edge_loop );
+    return add_face( edge_loop, count );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::extrude_vertex( const EdgeHandle edge, vec3 offset )
 {
+    LINKEDMESH_STATS_TIME( m_stats.extrude_vertex );
+
     assert( edge->next );
     assert( edge->opposing == nullptr );
     /*
@@ -283,18 +393,20 @@ LinkedMesh::FaceHandle LinkedMesh::extrude_vertex( const EdgeHandle edge, vec3 o
         edge->next->vertex
     };
 
-    std::vector<EdgeHandle> edge_loop;
-    edge_loop.emplace_back( add_halfedge( vertex[1] ) );
-    link_edges( edge_loop.back(), edge );
-    edge_loop.emplace_back( add_halfedge( vertex[0] ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( vertex[0]->position + offset ) ) );
+    EdgeHandle edge_loop[3];
+    edge_loop[0] = add_halfedge( vertex[1] );
+    link_edges( edge_loop[0], edge );
+    edge_loop[1] = add_halfedge( vertex[0] );
+    edge_loop[2] = add_halfedge( add_vertex( vertex[0]->position + offset ) );
 
-    return add_face( edge_loop );
+    return add_face( edge_loop, 3 );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::extrude_edge( const EdgeHandle edge, const vec3 & offset )
 {
+    LINKEDMESH_STATS_TIME( m_stats.extrude_edge );
+
     assert( edge->next );
     assert( edge->opposing == nullptr );
 
@@ -315,36 +427,43 @@ LinkedMesh::FaceHandle LinkedMesh::extrude_edge( const EdgeHandle edge, const ve
         edge->next->vertex
     };
 
-    std::vector<EdgeHandle> edge_loop;
-    edge_loop.emplace_back( add_halfedge( vertex[1] ) );
-    link_edges( edge_loop.back(), edge );
-    edge_loop.emplace_back( add_halfedge( vertex[0] ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( vertex[0]->position + offset, vertex[0]->color ) ) );
-    edge_loop.emplace_back( add_halfedge( add_vertex( vertex[1]->position + offset, vertex[1]->color ) ) );
+    EdgeHandle edge_loop[4];
+    edge_loop[0] = add_halfedge( vertex[1] );
+    link_edges( edge_loop[0], edge );
+    edge_loop[1] = add_halfedge( vertex[0] );
+    edge_loop[2] = add_halfedge( add_vertex( vertex[0]->position + offset, vertex[0]->color ) );
+    edge_loop[3] = add_halfedge( add_vertex( vertex[1]->position + offset, vertex[1]->color ) );
 
-    return add_face( edge_loop );
+    return add_face( edge_loop, 4 );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
 LinkedMesh::FaceHandle LinkedMesh::extrude_face( const FaceHandle face, const vec3 & offset )
 {
-    std::vector<FaceHandle> extruded_faces;
-    std::vector<EdgeHandle> cap_edges;
+    LINKEDMESH_STATS_TIME( m_stats.extrude_face );
+
+    /// temporaries come from the scratch arena, released when the scope ends
+    ScratchArena::Scope scope( m_scratch );
+
+    const auto count = edge_count( *face );
+    const auto extruded_faces = m_scratch.allocate<FaceHandle>( count );
+    const auto cap_edges = m_scratch.allocate<EdgeHandle>( count );
     const auto first_edge = face->edge;
     auto edge = face->edge;
+    size_t extruded_count = 0;
 
     do
     {
-        extruded_faces.emplace_back( extrude_edge( edge, offset ) );
+        extruded_faces[extruded_count++] = extrude_edge( edge, offset );
     }
     while( ( edge = edge->next ) != first_edge );
 
-    for( unsigned int i = 0; i < extruded_faces.size(); ++i )
+    for( unsigned int i = 0; i < count; ++i )
     {
         /// the first edge should be linked to the base
         // assert( extruded_faces[i]->edge->opposing->opposing == extruded_faces[i]->edge );
 
-        auto next_in_loop = ( i+1 )%extruded_faces.size();
+        auto next_in_loop = ( i+1 )%count;
 
         //std::cout << " [0]:" << extruded_faces[i]->edge << " [1]:" << extruded_faces[i]->edge->next << " [2]:" << extruded_faces[i]->edge->next->next << " [3]:" << extruded_faces[i]->edge->next->next->next << std::endl;
         //std::cout << " [ ]:" << extruded_faces[i]->edge->opposing << " [ ]:" << extruded_faces[i]->edge->next->opposing << " [ ]:" << extruded_faces[i]->edge->next->next->opposing << " [ ]:" << extruded_faces[i]->edge->next->next->next->opposing << std::endl;
@@ -352,226 +471,1372 @@ LinkedMesh::FaceHandle LinkedMesh::extrude_face( const FaceHandle face, const ve
         link_edges( extruded_faces[i]->edge->next->next->next, extruded_faces[next_in_loop]->edge->next );
         //assert( extruded_faces[i]->edge->next->vertex->position == extruded_faces[next_in_loop]->edge->next->next->opposing->vertex->position );
 
-        cap_edges.emplace_back( add_halfedge( extruded_faces[i]->edge->next->next->vertex ) );
-        link_edges( extruded_faces[i]->edge->next->next, cap_edges.back() );
+        cap_edges[i] = add_halfedge( extruded_faces[i]->edge->next->next->vertex );
+        link_edges( extruded_faces[i]->edge->next->next, cap_edges[i] );
     }
 
-    return add_face( cap_edges );
+    return add_face( cap_edges, count );
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
-void LinkedMesh::points( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
+void LinkedMesh::extrude_faces( const FaceHandle * faces, const size_t count, const vec3 & offset, const ExtrudeMode mode )
 {
-    for( const auto & vertex : m_vertices )
+    touch_logged();
+
+    LINKEDMESH_STATS_TIME( m_stats.extrude_faces );
+
+    if( mode == ExtrudeMode::Region )
     {
-        position_buffer.emplace_back( vertex->position[0] );
-        position_buffer.emplace_back( vertex->position[1] );
-        position_buffer.emplace_back( vertex->position[2] );
-        position_buffer.emplace_back( 1.0f );
+        extrude_region( faces, count, offset );
+        return;
+    }
 
-        color_buffer.emplace_back( vertex->color[0] );
-        color_buffer.emplace_back( vertex->color[1] );
-        color_buffer.emplace_back( vertex->color[2] );
-        color_buffer.emplace_back( 1.0f );
+    for( size_t i = 0; i < count; ++i )
+    {
+        extrude_region( faces + i, 1, offset );
     }
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
-void LinkedMesh::triangles( std::vector<Mesh::Vertex> & vertices )
+void LinkedMesh::extrude_faces( const std::vector<FaceHandle> & faces, const vec3 & offset, const ExtrudeMode mode )
 {
-    auto barycenter = vec3();
+    extrude_faces( faces.data(), faces.size(), offset, mode );
+}
 
-    for( const auto & face : m_faces )
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::extrude_region( const FaceHandle * faces, const size_t count, const vec3 & offset )
+{
+    /*
+        every boundary edge of the region gets a wall, the faces move to the new vertices
+
+        nv0 <-c- nv1        c is linked to the moved boundary edge
+         |        ^         a is linked to the edge that was opposing the boundary edge
+         d  wall  b         b and d are linked to the walls of the neighbouring boundary edges
+         v        |
+        v0 --a--> v1
+    */
+
+    m_face_mark.resize( m_faces.size(), 0 );
+    m_vertex_map.resize( m_vertices.size(), nullptr );
+    m_extrude_boundary.clear();
+    m_extrude_corners.clear();
+
+    for( size_t i = 0; i < count; ++i )
     {
-        if( face->edge == nullptr ) continue;
+        m_face_mark[faces[i]->id] = 1;
+    }
 
-        //compute_normal( face.get() );
+    auto selected = [this]( const FaceHandle face )
+    {
+        /// faces added during the extrusion are past the end of m_face_mark and never selected
+        return face != nullptr && face->id < m_face_mark.size() && m_face_mark[face->id];
+    };
 
-        const auto first_edge = face->edge;
-        auto edge = first_edge;
-        unsigned int vertex_count = 0;
-        unsigned int barycenter_index = 0;
+    auto internal = [&]( const EdgeHandle edge )
+    {
+        return edge->opposing != nullptr && selected( edge->opposing->face );
+    };
 
-        do
+    /// collect the boundary and the corners before anything changes
+    for( size_t i = 0; i < count; ++i )
+    {
+        for( const auto edge : edges( faces[i] ) )
         {
-            barycenter = vec3( 0.0f, 0.0f, 0.0f );
-            barycenter[barycenter_index++] = 1.0f;
+            if( !internal( edge ) )
+            {
+                m_extrude_boundary.push_back( { edge, edge->vertex, edge->next->vertex, edge->opposing, nullptr } );
+            }
+
+            const auto vertex = edge->vertex;
 
-            vertices.push_back( Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face->normal, edge->texcoord, barycenter, edge->vertex->light ) );
-            if( ++vertex_count % 3 == 0 )
+            if( m_vertex_map[vertex->id] == nullptr )
             {
-                barycenter_index = 0;
-                barycenter = vec3( 0.0f, 0.0f, 0.0f );
-                barycenter[barycenter_index++] = 1.0f;
-                vertices.push_back( Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face->normal, edge->texcoord, barycenter, edge->vertex->light ) );
+                /// mark the corner as visited until its new vertex exists
+                m_vertex_map[vertex->id] = vertex;
+                m_extrude_corners.push_back( vertex );
             }
-            edge = edge->next;
         }
-        while( edge != first_edge );
-        vertices.push_back( Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face->normal, edge->texcoord, vec3( 0.0f, 0.0f, 1.0f ), edge->vertex->light ) );
     }
-}
 
-/// ////////////////////////////////////////////////////////////////////////////
-void LinkedMesh::triangles( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
-{
-    /// every face stored
-    for( const auto & face : m_faces )
+    m_vertices.reserve( m_vertices.size() + m_extrude_corners.size() );
+    m_edges.reserve( m_edges.size() + m_extrude_boundary.size() * 4 );
+    m_faces.reserve( m_faces.size() + m_extrude_boundary.size() );
+
+    /// a corner is left without faces when all of its faces move
+    m_extrude_orphans.clear();
+
+    for( const auto vertex : m_extrude_corners )
     {
-        if( face->edge == nullptr )
+        bool orphan = true;
+
+        for( const auto edge : one_ring( vertex ) )
         {
-            continue;
+            orphan = orphan && selected( edge->face );
         }
 
-        /// starting edge of this edgeloop, used as break condition
-        const auto first_edge = face->edge;
+        if( orphan )
+        {
+            m_extrude_orphans.push_back( vertex );
+        }
 
-        /// current edge in the process
-        auto edge = first_edge->next;
+        /// add_vertex may reuse a freed vertex, map entries are only read for corners
+        m_vertex_map[vertex->id] = add_vertex( vertex->position + offset, vertex->color );
+    }
 
-        ///count the number of vertices triangulated
-        unsigned int vertex_counter = 0;
+    /// move the faces to the new vertices
+    for( size_t i = 0; i < count; ++i )
+    {
+        for( const auto edge : edges( faces[i] ) )
+        {
+            const auto old_vertex = edge->vertex;
+            edge->vertex = m_vertex_map[old_vertex->id];
+            log_edge( edge->id );
+
+            if( edge->vertex->edge == nullptr )
+            {
+                edge->vertex->edge = edge;
+                log_vertex( edge->vertex->id );
+            }
+
+            if( old_vertex->edge == edge )
+            {
+                old_vertex->edge = nullptr;
+                log_vertex( old_vertex->id );
+            }
+        }
+
+        queue_dirty( faces[i] );
+    }
+
+    /// build the walls, their sides are linked once every wall exists
+    EdgeHandle wall[4];
+
+    for( auto & boundary : m_extrude_boundary )
+    {
+        const auto new_vertex0 = m_vertex_map[boundary.vertex0->id];
+        const auto new_vertex1 = m_vertex_map[boundary.vertex1->id];
+
+        wall[0] = add_halfedge( boundary.vertex0 );
+        wall[1] = add_halfedge( boundary.vertex1 );
+        wall[2] = add_halfedge( new_vertex1 );
+        wall[3] = add_halfedge( new_vertex0 );
+
+        add_face( wall, 4 );
 
-        /// every edge in edgeloop
-        while( edge != first_edge )
+        if( boundary.opposing != nullptr )
         {
-            assert( edge->vertex );
+            link_edges( wall[0], boundary.opposing );
+        }
 
-            position_buffer.emplace_back( edge->vertex->position[0] );
-            position_buffer.emplace_back( edge->vertex->position[1] );
-            position_buffer.emplace_back( edge->vertex->position[2] );
-            position_buffer.emplace_back( 1.0f );
+        link_edges( wall[2], boundary.edge );
 
-            color_buffer.emplace_back( edge->vertex->color[0] );
-            color_buffer.emplace_back( edge->vertex->color[1] );
-            color_buffer.emplace_back( edge->vertex->color[2] );
-            color_buffer.emplace_back( edge->vertex->color[3] );
+        /// the boundary vertices keep an outgoing halfedge in the wall
+        boundary.vertex0->edge = wall[0];
+        boundary.side = wall[1];
+        log_vertex( boundary.vertex0->id );
+    }
 
-            if( ( ++vertex_counter % 2 ) == 0 )
-            {
-                position_buffer.emplace_back( first_edge->vertex->position[0] );
-                position_buffer.emplace_back( first_edge->vertex->position[1] );
-                position_buffer.emplace_back( first_edge->vertex->position[2] );
-                position_buffer.emplace_back( 1.0f );
+    for( const auto & boundary : m_extrude_boundary )
+    {
+        /// the next boundary edge of the region starts where this one ends
+        auto next = boundary.edge->next;
 
-                color_buffer.emplace_back( first_edge->vertex->color[0] );
-                color_buffer.emplace_back( first_edge->vertex->color[1] );
-                color_buffer.emplace_back( first_edge->vertex->color[2] );
-                color_buffer.emplace_back( first_edge->vertex->color[3] );
+        while( internal( next ) )
+        {
+            next = next->opposing->next;
+        }
 
-                if( edge->next == first_edge )
-                {
-                    break;
-                }
-            }
-            else
-            {
-                edge = edge->next;
-            }
+        /// its wall is reached through the moved edge: c -> d
+        link_edges( boundary.side, next->opposing->next );
+    }
+
+    for( const auto vertex : m_extrude_orphans )
+    {
+        if( vertex->edge == nullptr )
+        {
+            free_vertex( vertex );
         }
     }
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        m_face_mark[faces[i]->id] = 0;
+    }
+
+    for( const auto vertex : m_extrude_corners )
+    {
+        m_vertex_map[vertex->id] = nullptr;
+    }
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
-void LinkedMesh::clear()
+void LinkedMesh::points( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
 {
-    m_vertices.clear();
-    m_edges.clear();
-    m_faces.clear();
+    LINKEDMESH_STATS_TIME( m_stats.points );
+
+    for( const auto & vertex : m_vertices )
+    {
+        /// skip vertices on the free list
+        if( !vertex.initialized ) continue;
+
+        position_buffer.emplace_back( vertex.position[0] );
+        position_buffer.emplace_back( vertex.position[1] );
+        position_buffer.emplace_back( vertex.position[2] );
+        position_buffer.emplace_back( 1.0f );
+
+        color_buffer.emplace_back( vertex.color[0] );
+        color_buffer.emplace_back( vertex.color[1] );
+        color_buffer.emplace_back( vertex.color[2] );
+        color_buffer.emplace_back( 1.0f );
+    }
 }
 
 /// ////////////////////////////////////////////////////////////////////////////
-void LinkedMesh::reset()
+size_t LinkedMesh::triangle_vertex_count() const
 {
-    auto reset_face = []( std::unique_ptr<Face> & face )
+    size_t count = 0;
+
+    for( const auto & face : m_faces )
     {
-        face->edge = nullptr;
-        face->initialized = false;
+        if( face.edge == nullptr ) continue;
 
-        return face->id;
-    };
+        count += triangle_vertex_count( face );
+    }
 
-    auto reset_edge = []( std::unique_ptr<Edge> & edge )
-    {
-        edge->face = nullptr;
-        edge->next = nullptr;
-        edge->opposing = nullptr;
-        edge->vertex = nullptr;
-        edge->initialized = false;
+    return count;
+}
 
-        return edge->id;
-    };
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::triangle_float_count() const
+{
+    size_t count = 0;
 
-    auto reset_vertex = []( std::unique_ptr<Vertex> & vertex )
+    for( const auto & face : m_faces )
     {
-        vertex->color = vec4( 0.0f, 0.0f, 0.0f, 1.0f );
-        vertex->position = vec3( 0.0f, 0.0f, 0.0f );
-        vertex->initialized = false;
+        if( face.edge == nullptr ) continue;
 
-        return vertex->id;
-    };
+        count += triangle_corner_count( face ) * 4;
+    }
+
+    return count;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::write_triangles( const Face & face, Mesh::Vertex * vertices )
+{
+    auto barycenter = vec3();
 
-//			for( auto & vertex : m_vertices )
-//			{
-//				if( vertex->initialized )
-//				{
-//					reset_vertex( vertex );
-//					m_free_vertices.push_back( vertex->id );
-//				}
-//			}
+    const auto first_edge = face.edge;
+    auto edge = first_edge;
+    auto out = vertices;
+    unsigned int vertex_count = 0;
+    unsigned int barycenter_index = 0;
 
-    for( auto & edge : m_edges )
+    do
     {
-        if( edge->initialized )
+        barycenter = vec3( 0.0f, 0.0f, 0.0f );
+        barycenter[barycenter_index++] = 1.0f;
+
+        *out++ = Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face.normal, edge->texcoord, barycenter, edge->vertex->light );
+        if( ++vertex_count % 3 == 0 )
         {
-            reset_edge( edge );
-            m_free_edges.push_back( edge->id );
+            barycenter_index = 0;
+            barycenter = vec3( 0.0f, 0.0f, 0.0f );
+            barycenter[barycenter_index++] = 1.0f;
+            *out++ = Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face.normal, edge->texcoord, barycenter, edge->vertex->light );
         }
+        edge = edge->next;
     }
+    while( edge != first_edge );
+    *out++ = Mesh::Vertex( vec4( vec3( edge->vertex->position ), 1.0f ), edge->vertex->color, face.normal, edge->texcoord, vec3( 0.0f, 0.0f, 1.0f ), edge->vertex->light );
 
-    for( auto & face : m_faces )
+    return out - vertices;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::write_triangles( const Face & face, float * position_buffer, float * color_buffer )
+{
+    auto position_out = position_buffer;
+    auto color_out = color_buffer;
+
+    /// store one corner as two 4 float blocks
+    auto emit = [&]( const VertexHandle vertex )
+    {
+        std::memcpy( position_out, &vertex->position[0], 3 * sizeof( float ) );
+        position_out[3] = 1.0f;
+        std::memcpy( color_out, &vertex->color[0], 4 * sizeof( float ) );
+
+        position_out += 4;
+        color_out += 4;
+    };
+
+    /// starting edge of this edgeloop, used as break condition
+    const auto first_edge = face.edge;
+
+    /// current edge in the process
+    auto edge = first_edge->next;
+
+    ///count the number of vertices triangulated
+    unsigned int vertex_counter = 0;
+
+    /// every edge in edgeloop
+    while( edge != first_edge )
     {
-        if( face->initialized )
+        assert( edge->vertex );
+
+        emit( edge->vertex );
+
+        if( ( ++vertex_counter % 2 ) == 0 )
+        {
+            emit( first_edge->vertex );
+
+            if( edge->next == first_edge )
+            {
+                break;
+            }
+        }
+        else
         {
-            reset_face( face );
-            m_free_faces.push_back( face->id );
+            edge = edge->next;
         }
     }
+
+    return position_out - position_buffer;
 }
 
-/// /////////////////////////////////////////////////////////////////////////
-void LinkedMesh::compute_normal( const FaceHandle face )
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::triangles( Mesh::Vertex * vertices, const size_t capacity ) const
 {
-    assert( face != nullptr );
+    /// a short buffer is left alone, it may be mapped memory nothing else guards
+    if( triangle_vertex_count() > capacity )
+    {
+        return 0;
+    }
 
-    std::vector<VertexHandle> v;
+    return write_all_triangles( vertices );
+}
 
-    const auto first_edge = face->edge;
-    auto edge = first_edge;
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::triangles( float * position_buffer, float * color_buffer, const size_t capacity ) const
+{
+    if( triangle_float_count() > capacity )
+    {
+        return 0;
+    }
 
-    do
+    return write_all_triangles( position_buffer, color_buffer );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::write_all_triangles( Mesh::Vertex * vertices ) const
+{
+    LINKEDMESH_STATS_TIME( m_stats.triangles );
+
+    size_t written = 0;
+
+    for( const auto & face : m_faces )
     {
-        v.push_back( edge->vertex );
-        edge = edge->next;
+        if( face.edge == nullptr ) continue;
+
+        written += write_triangles( face, vertices + written );
     }
-    while( edge != first_edge );
 
-    auto vector1 = v[0]->position - v[1]->position;
-    auto vector2 = v[0]->position - v[2]->position;
-    face->normal = glm::normalize( glm::cross( vector1, vector2 ) );
+    return written;
 }
 
-/// /////////////////////////////////////////////////////////////////////////
-void LinkedMesh::compute_barycenter( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c, float & u, float & v, float & w )
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::write_all_triangles( float * position_buffer, float * color_buffer ) const
 {
-    vec3 v0 = b - a, v1 = c - a, v2 = p - a;
-    float d00 = glm::dot( v0, v0 );
-    float d01 = glm::dot( v0, v1 );
-    float d11 = glm::dot( v1, v1 );
-    float d20 = glm::dot( v2, v0 );
-    float d21 = glm::dot( v2, v1 );
-    float denom = d00 * d11 - d01 * d01;
-    v = ( d11 * d20 - d01 * d21 ) / denom;
-    w = ( d00 * d21 - d01 * d20 ) / denom;
-    u = 1.0f - v - w;
+    LINKEDMESH_STATS_TIME( m_stats.triangles );
+
+    size_t written = 0;
+
+    /// every face stored
+    for( const auto & face : m_faces )
+    {
+        if( face.edge == nullptr ) continue;
+
+        written += write_triangles( face, position_buffer + written, color_buffer + written );
+    }
+
+    return written;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles( std::vector<Mesh::Vertex> & vertices )
+{
+    /// size the output once, then fill it without growing
+    const auto offset = vertices.size();
+    const auto count = triangle_vertex_count();
+
+    vertices.resize( offset + count );
+    write_all_triangles( vertices.data() + offset );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles( std::vector<float> & position_buffer, std::vector<float> & color_buffer )
+{
+    /// size the output once, then fill it without growing
+    const auto position_offset = position_buffer.size();
+    const auto color_offset = color_buffer.size();
+    const auto count = triangle_float_count();
+
+    position_buffer.resize( position_offset + count );
+    color_buffer.resize( color_offset + count );
+    write_all_triangles( position_buffer.data() + position_offset, color_buffer.data() + color_offset );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles_parallel( std::vector<Mesh::Vertex> & vertices, const unsigned int thread_count )
+{
+    LINKEDMESH_STATS_TIME( m_stats.triangles_parallel );
+
+    const auto threads = parallel_thread_count( m_faces.size(), thread_count, parallel_faces_per_thread );
+
+    /// count the output of every block of faces
+    std::vector<size_t> block_offsets( threads + 1, 0 );
+
+    parallel_for_blocks( m_faces.size(), threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        size_t count = 0;
+
+        for( size_t i = begin; i < end; ++i )
+        {
+            if( m_faces[i].edge == nullptr ) continue;
+
+            count += triangle_vertex_count( m_faces[i] );
+        }
+
+        block_offsets[block + 1] = count;
+    } );
+
+    /// prefix sum gives every block its first output vertex
+    block_offsets[0] = vertices.size();
+
+    for( unsigned int block = 0; block < threads; ++block )
+    {
+        block_offsets[block + 1] += block_offsets[block];
+    }
+
+    vertices.resize( block_offsets.back() );
+    const auto out = vertices.data();
+
+    parallel_for_blocks( m_faces.size(), threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        auto written = block_offsets[block];
+
+        for( size_t i = begin; i < end; ++i )
+        {
+            if( m_faces[i].edge == nullptr ) continue;
+
+            written += write_triangles( m_faces[i], out + written );
+        }
+
+        assert( written == block_offsets[block + 1] );
+    } );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles_parallel( std::vector<float> & position_buffer, std::vector<float> & color_buffer, const unsigned int thread_count )
+{
+    LINKEDMESH_STATS_TIME( m_stats.triangles_parallel );
+
+    assert( position_buffer.size() == color_buffer.size() );
+
+    const auto threads = parallel_thread_count( m_faces.size(), thread_count, parallel_faces_per_thread );
+
+    /// count the output of every block of faces
+    std::vector<size_t> block_offsets( threads + 1, 0 );
+
+    parallel_for_blocks( m_faces.size(), threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        size_t count = 0;
+
+        for( size_t i = begin; i < end; ++i )
+        {
+            if( m_faces[i].edge == nullptr ) continue;
+
+            count += triangle_corner_count( m_faces[i] ) * 4;
+        }
+
+        block_offsets[block + 1] = count;
+    } );
+
+    /// prefix sum gives every block its first output float
+    block_offsets[0] = position_buffer.size();
+
+    for( unsigned int block = 0; block < threads; ++block )
+    {
+        block_offsets[block + 1] += block_offsets[block];
+    }
+
+    position_buffer.resize( block_offsets.back() );
+    color_buffer.resize( block_offsets.back() );
+    const auto position_out = position_buffer.data();
+    const auto color_out = color_buffer.data();
+
+    parallel_for_blocks( m_faces.size(), threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        auto written = block_offsets[block];
+
+        for( size_t i = begin; i < end; ++i )
+        {
+            if( m_faces[i].edge == nullptr ) continue;
+
+            written += write_triangles( m_faces[i], position_out + written, color_out + written );
+        }
+
+        assert( written == block_offsets[block + 1] );
+    } );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles_indexed( std::vector<Mesh::Vertex> & vertices, std::vector<uint32_t> & indices )
+{
+    LINKEDMESH_STATS_TIME( m_stats.triangles_indexed );
+
+    const uint32_t none = 0xFFFFFFFFu;
+    const auto first_vertex = vertices.size();
+
+    /// the attributes a corner is split by, per emitted vertex
+    struct CornerKey
+    {
+        vec3 normal;
+        vec2 texcoord;
+        uint32_t next;
+    };
+
+    /// emitted vertices of every mesh vertex, chained through CornerKey::next
+    std::vector<uint32_t> first_corner( m_vertices.size(), none );
+    std::vector<CornerKey> corners;
+    corners.reserve( m_vertices.size() );
+    vertices.reserve( first_vertex + m_vertices.size() );
+
+    /// size the index buffer once
+    const auto first_index = indices.size();
+    size_t index_count = 0;
+
+    for( const auto & face : m_faces )
+    {
+        if( face.edge == nullptr ) continue;
+
+        index_count += triangle_corner_count( face );
+    }
+
+    indices.resize( first_index + index_count );
+    auto out = indices.data() + first_index;
+
+    auto emit = [&]( const Face & face, const EdgeHandle edge )
+    {
+        const auto vertex = edge->vertex;
+
+        for( auto corner = first_corner[vertex->id]; corner != none; corner = corners[corner].next )
+        {
+            if( corners[corner].normal == face.normal && corners[corner].texcoord == edge->texcoord )
+            {
+                return static_cast<uint32_t>( first_vertex + corner );
+            }
+        }
+
+        const auto corner = static_cast<uint32_t>( corners.size() );
+        corners.push_back( { face.normal, edge->texcoord, first_corner[vertex->id] } );
+        first_corner[vertex->id] = corner;
+
+        vertices.push_back( Mesh::Vertex( vec4( vertex->position, 1.0f ), vertex->color, face.normal, edge->texcoord, vec3( 0.0f, 0.0f, 0.0f ), vertex->light ) );
+        return static_cast<uint32_t>( first_vertex + corner );
+    };
+
+    for( const auto & face : m_faces )
+    {
+        if( face.edge == nullptr ) continue;
+
+        /// fan around the first edge, same triangles as triangles( position_buffer, color_buffer )
+        const auto first_edge = face.edge;
+        const auto pivot = emit( face, first_edge );
+        auto edge = first_edge->next;
+        auto previous = emit( face, edge );
+
+        while( ( edge = edge->next ) != first_edge )
+        {
+            const auto current = emit( face, edge );
+
+            *out++ = previous;
+            *out++ = current;
+            *out++ = pivot;
+
+            previous = current;
+        }
+    }
+
+    assert( out == indices.data() + indices.size() );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::mark_dirty( const FaceHandle face )
+{
+    touch_attributes();
+    queue_dirty( face );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::mark_dirty( const VertexHandle vertex )
+{
+    touch_attributes();
+    queue_dirty_vertex( vertex );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::queue_dirty_vertex( const VertexHandle vertex )
+{
+    if( m_fans_checked && !m_split_fans )
+    {
+        queue_dirty( vertex );
+        return;
+    }
+
+    /// resolved by the next export, once it is known whether the one ring is enough
+    if( !vertex->dirty )
+    {
+        vertex->dirty = true;
+        m_dirty_vertices.push_back( vertex );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool LinkedMesh::has_split_fans()
+{
+    if( m_fans_checked )
+    {
+        return m_split_fans;
+    }
+
+    /// halfedges of faces leaving every vertex, the fan of a vertex must reach as many
+    std::vector<uint32_t> outgoing( m_vertices.size(), 0 );
+
+    for( const auto & edge : m_edges )
+    {
+        if( edge.initialized && edge.face != nullptr && edge.vertex != nullptr )
+        {
+            ++outgoing[edge.vertex->id];
+        }
+    }
+
+    m_split_fans = false;
+
+    for( size_t i = 0; i < m_vertices.size() && !m_split_fans; ++i )
+    {
+        const auto vertex = &m_vertices[i];
+        uint32_t fan = 0;
+
+        if( vertex->edge != nullptr )
+        {
+            for( const auto edge : one_ring( vertex ) )
+            {
+                /// a ring running past the count does not belong to this vertex alone
+                if( edge->face != nullptr && ++fan > outgoing[i] ) break;
+            }
+        }
+
+        m_split_fans = fan != outgoing[i];
+    }
+
+    m_fans_checked = true;
+    return m_split_fans;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::triangles_incremental( std::vector<Mesh::Vertex> & vertices, std::vector<ExportRange> & changed )
+{
+    LINKEDMESH_STATS_TIME( m_stats.triangles_incremental );
+
+    changed.clear();
+
+    auto exported_face_count = m_export_offsets.empty() ? 0 : m_export_offsets.size() - 1;
+
+    if( m_export_layout_valid && !m_dirty_vertices.empty() )
+    {
+        /// A changed vertex changes the output of every face using it. Queued without touch(), the mesh
+        /// itself does not change here and caches of the current revision stay valid
+        if( has_split_fans() )
+        {
+            /// the one ring of vertex->edge misses faces of other fans, find the uses in every halfedge
+            for( const auto & edge : m_edges )
+            {
+                if( edge.face != nullptr && edge.vertex != nullptr && edge.vertex->dirty )
+                {
+                    queue_dirty( edge.face );
+                }
+            }
+        }
+        else
+        {
+            for( const auto vertex : m_dirty_vertices )
+            {
+                queue_dirty( vertex );
+            }
+        }
+    }
+
+    if( m_export_layout_valid && vertices.size() == m_export_offsets.back() )
+    {
+        /// rewrite changed faces in place, as long as their output keeps its size
+        for( const auto face : m_dirty_faces )
+        {
+            if( face->id >= exported_face_count ) continue;
+
+            const auto offset = m_export_offsets[face->id];
+            const auto count = m_export_offsets[face->id + 1] - offset;
+
+            if( ( face->edge == nullptr ? 0 : triangle_vertex_count( *face ) ) != count )
+            {
+                m_export_layout_valid = false;
+                break;
+            }
+
+            if( count > 0 )
+            {
+                write_triangles( *face, vertices.data() + offset );
+                changed.push_back( { offset * sizeof( Mesh::Vertex ), count * sizeof( Mesh::Vertex ) } );
+            }
+        }
+    }
+    else
+    {
+        m_export_layout_valid = false;
+    }
+
+    if( !m_export_layout_valid )
+    {
+        /// the layout changed, export everything again
+        vertices.clear();
+        m_export_offsets.assign( 1, 0 );
+        exported_face_count = 0;
+        changed.clear();
+        m_export_layout_valid = true;
+    }
+
+    if( exported_face_count < m_faces.size() )
+    {
+        /// faces allocated since the last export are appended
+        const auto offset = vertices.size();
+        auto end = offset;
+
+        for( size_t i = exported_face_count; i < m_faces.size(); ++i )
+        {
+            if( m_faces[i].edge != nullptr )
+            {
+                end += triangle_vertex_count( m_faces[i] );
+            }
+        }
+
+        vertices.resize( end );
+        auto written = offset;
+
+        for( size_t i = exported_face_count; i < m_faces.size(); ++i )
+        {
+            if( m_faces[i].edge != nullptr )
+            {
+                written += write_triangles( m_faces[i], vertices.data() + written );
+            }
+
+            m_export_offsets.push_back( written );
+        }
+
+        if( end > offset )
+        {
+            changed.push_back( { offset * sizeof( Mesh::Vertex ), ( end - offset ) * sizeof( Mesh::Vertex ) } );
+        }
+    }
+
+    /// sort the ranges and merge the ones touching each other
+    std::sort( changed.begin(), changed.end(), []( const ExportRange & a, const ExportRange & b )
+    {
+        return a.offset < b.offset;
+    } );
+
+    size_t merged = 0;
+
+    for( size_t i = 0; i < changed.size(); ++i )
+    {
+        if( merged > 0 && changed[merged - 1].offset + changed[merged - 1].size >= changed[i].offset )
+        {
+            auto & last = changed[merged - 1];
+            last.size = std::max( last.offset + last.size, changed[i].offset + changed[i].size ) - last.offset;
+        }
+        else
+        {
+            changed[merged++] = changed[i];
+        }
+    }
+
+    changed.resize( merged );
+
+    for( const auto vertex : m_dirty_vertices )
+    {
+        vertex->dirty = false;
+    }
+
+    for( const auto face : m_dirty_faces )
+    {
+        face->dirty = false;
+    }
+
+    m_dirty_vertices.clear();
+    m_dirty_faces.clear();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::release_vertex( const VertexHandle vertex )
+{
+    touch();
+    free_vertex( vertex );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::free_vertex( const VertexHandle vertex )
+{
+    log_vertex( vertex->id );
+
+    vertex->color = vec4( 0.0f, 0.0f, 0.0f, 1.0f );
+    vertex->position = vec3( 0.0f, 0.0f, 0.0f );
+    vertex->light = 0.5f;
+    vertex->edge = nullptr;
+    vertex->initialized = false;
+
+    m_free_vertices.push_back( vertex->id );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::release_edge( const EdgeHandle edge )
+{
+    log_edge( edge->id );
+
+    edge->face = nullptr;
+    edge->next = nullptr;
+    edge->opposing = nullptr;
+    edge->vertex = nullptr;
+    edge->initialized = false;
+
+    m_free_edges.push_back( edge->id );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::release_face( const FaceHandle face )
+{
+    log_face( face->id );
+
+    face->edge = nullptr;
+    face->initialized = false;
+
+    m_free_faces.push_back( face->id );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::clear()
+{
+    touch();
+
+    m_vertices.clear();
+    m_edges.clear();
+    m_faces.clear();
+
+    m_free_vertices.clear();
+    m_free_edges.clear();
+    m_free_faces.clear();
+
+    m_dirty_vertices.clear();
+    m_dirty_faces.clear();
+    m_export_layout_valid = false;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::allocated_bytes() const
+{
+    return m_vertices.allocated_bytes() + m_edges.allocated_bytes() + m_faces.allocated_bytes() +
+           vector_bytes( m_free_vertices ) + vector_bytes( m_free_edges ) + vector_bytes( m_free_faces ) +
+           vector_bytes( m_dirty_faces ) + vector_bytes( m_dirty_vertices ) + vector_bytes( m_export_offsets ) +
+           vector_bytes( m_face_mark ) + vector_bytes( m_vertex_map ) + vector_bytes( m_extrude_boundary ) +
+           vector_bytes( m_extrude_corners ) + vector_bytes( m_extrude_orphans ) + vector_bytes( m_kernel_scratch ) +
+           m_scratch.allocated_bytes();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshStats LinkedMesh::stats() const
+{
+    MeshStats stats;
+    stats.free_vertices = m_free_vertices.size();
+    stats.free_edges = m_free_edges.size();
+    stats.free_faces = m_free_faces.size();
+    stats.live_vertices = m_vertices.size() - stats.free_vertices;
+    stats.live_edges = m_edges.size() - stats.free_edges;
+    stats.live_faces = m_faces.size() - stats.free_faces;
+    stats.allocated_bytes = allocated_bytes();
+    stats.counters = m_stats;
+
+#if defined( LINKEDMESH_STATS )
+    stats.collecting = true;
+#endif
+
+    for( const auto & vertex : m_vertices )
+    {
+        if( vertex.initialized && vertex.edge == nullptr )
+        {
+            ++stats.unreferenced_vertices;
+        }
+    }
+
+    return stats;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+ExportCache & LinkedMesh::export_cache()
+{
+    return *m_export_cache;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::reset_stats()
+{
+    m_stats = MeshStats::Counters();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::reset()
+{
+    touch_logged();
+    log_all();
+
+    for( auto & vertex : m_vertices )
+    {
+        if( vertex.initialized )
+        {
+            free_vertex( &vertex );
+        }
+    }
+
+    for( auto & edge : m_edges )
+    {
+        if( edge.initialized )
+        {
+            release_edge( &edge );
+        }
+    }
+
+    for( auto & face : m_faces )
+    {
+        if( face.initialized )
+        {
+            release_face( &face );
+        }
+    }
+
+    for( const auto vertex : m_dirty_vertices )
+    {
+        vertex->dirty = false;
+    }
+
+    for( const auto face : m_dirty_faces )
+    {
+        face->dirty = false;
+    }
+
+    m_dirty_vertices.clear();
+    m_dirty_faces.clear();
+    m_export_layout_valid = false;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compact( CompactionMap & map )
+{
+    touch();
+
+    const auto vertex_count = number_live_elements( m_vertices, map.vertices );
+    const auto edge_count = number_live_elements( m_edges, map.edges );
+    const auto face_count = number_live_elements( m_faces, map.faces );
+
+    /// copy the live elements into fresh slabs, which only hold as many slabs as needed
+    SlabPool<Vertex> vertices;
+    SlabPool<Edge> edges;
+    SlabPool<Face> faces;
+    vertices.reserve( vertex_count );
+    edges.reserve( edge_count );
+    faces.reserve( face_count );
+
+    for( const auto & vertex : m_vertices )
+    {
+        if( !vertex.initialized ) continue;
+
+        auto & copy = vertices.emplace_back( vertices.size(), vertex.position, vertex.color );
+        copy.edge = vertex.edge;
+        copy.light = vertex.light;
+        copy.initialized = true;
+    }
+
+    for( const auto & face : m_faces )
+    {
+        if( !face.initialized ) continue;
+
+        auto & copy = faces.emplace_back( faces.size(), face.edge );
+        copy.normal = face.normal;
+        copy.color = face.color;
+        copy.initialized = true;
+    }
+
+    for( const auto & edge : m_edges )
+    {
+        if( !edge.initialized ) continue;
+
+        auto & copy = edges.emplace_back( edges.size(), edge.vertex ? &vertices[map.vertices[edge.vertex->id]] : nullptr );
+        copy.texcoord = edge.texcoord;
+        copy.barycenter = edge.barycenter;
+        copy.initialized = true;
+    }
+
+    /// remap the links, every copy still points into the old slabs
+    auto remap_edge = [&]( const EdgeHandle edge ) -> EdgeHandle
+    {
+        return edge ? &edges[map.edges[edge->id]] : nullptr;
+    };
+
+    for( auto & copy : vertices )
+    {
+        copy.edge = remap_edge( copy.edge );
+    }
+
+    for( auto & copy : faces )
+    {
+        copy.edge = remap_edge( copy.edge );
+    }
+
+    for( size_t i = 0; i < m_edges.size(); ++i )
+    {
+        const auto & edge = m_edges[i];
+
+        if( !edge.initialized ) continue;
+
+        auto & copy = edges[map.edges[i]];
+        copy.next = remap_edge( edge.next );
+        copy.opposing = remap_edge( edge.opposing );
+        copy.face = edge.face ? &faces[map.faces[edge.face->id]] : nullptr;
+    }
+
+    m_vertices.swap( vertices );
+    m_edges.swap( edges );
+    m_faces.swap( faces );
+
+    m_free_vertices.clear();
+    m_free_edges.clear();
+    m_free_faces.clear();
+
+    m_dirty_vertices.clear();
+    m_dirty_faces.clear();
+    m_export_layout_valid = false;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::append( const LinkedMesh & other, CompactionMap & map )
+{
+    touch_logged();
+
+    assert( &other != this );
+
+    const auto vertex_count = number_live_elements( other.m_vertices, map.vertices );
+    const auto edge_count = number_live_elements( other.m_edges, map.edges );
+    const auto face_count = number_live_elements( other.m_faces, map.faces );
+
+    const auto vertex_base = static_cast<uint32_t>( m_vertices.grow( vertex_count ) );
+    const auto edge_base = static_cast<uint32_t>( m_edges.grow( edge_count ) );
+    const auto face_base = static_cast<uint32_t>( m_faces.grow( face_count ) );
+
+    if( logging() )
+    {
+        log_ids( m_change_log.vertices, vertex_base, vertex_count );
+        log_ids( m_change_log.edges, edge_base, edge_count );
+        log_ids( m_change_log.faces, face_base, face_count );
+    }
+
+    rebase_indices( map.vertices, vertex_base );
+    rebase_indices( map.edges, edge_base );
+    rebase_indices( map.faces, face_base );
+
+    copy_elements( other, map );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::append( const std::vector<const LinkedMesh *> & others, std::vector<CompactionMap> & maps, const unsigned int thread_count )
+{
+    touch_logged();
+
+    maps.resize( others.size() );
+
+    size_t element_count = 0;
+
+    for( const auto other : others )
+    {
+        assert( other != this );
+        element_count += other->m_vertices.size() + other->m_edges.size() + other->m_faces.size();
+    }
+
+    const auto threads = std::min<size_t>( others.size(), parallel_thread_count( element_count, thread_count, parallel_faces_per_thread ) );
+
+    /// live elements of every mesh, numbered from 0
+    std::vector<uint32_t> counts( others.size() * 3 );
+
+    parallel_for_blocks( others.size(), static_cast<unsigned int>( threads ), [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            counts[i * 3 + 0] = number_live_elements( others[i]->m_vertices, maps[i].vertices );
+            counts[i * 3 + 1] = number_live_elements( others[i]->m_edges, maps[i].edges );
+            counts[i * 3 + 2] = number_live_elements( others[i]->m_faces, maps[i].faces );
+        }
+    } );
+
+    /// the ranges of the meshes follow each other in order
+    std::vector<uint32_t> bases( others.size() * 3 );
+
+    for( size_t i = 0; i < others.size(); ++i )
+    {
+        bases[i * 3 + 0] = static_cast<uint32_t>( m_vertices.grow( counts[i * 3 + 0] ) );
+        bases[i * 3 + 1] = static_cast<uint32_t>( m_edges.grow( counts[i * 3 + 1] ) );
+        bases[i * 3 + 2] = static_cast<uint32_t>( m_faces.grow( counts[i * 3 + 2] ) );
+
+        if( logging() )
+        {
+            log_ids( m_change_log.vertices, bases[i * 3 + 0], counts[i * 3 + 0] );
+            log_ids( m_change_log.edges, bases[i * 3 + 1], counts[i * 3 + 1] );
+            log_ids( m_change_log.faces, bases[i * 3 + 2], counts[i * 3 + 2] );
+        }
+    }
+
+    /// every mesh only writes its own range and links within it
+    parallel_for_blocks( others.size(), static_cast<unsigned int>( threads ), [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = begin; i < end; ++i )
+        {
+            rebase_indices( maps[i].vertices, bases[i * 3 + 0] );
+            rebase_indices( maps[i].edges, bases[i * 3 + 1] );
+            rebase_indices( maps[i].faces, bases[i * 3 + 2] );
+
+            copy_elements( *others[i], maps[i] );
+        }
+    } );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::copy_elements( const LinkedMesh & other, const CompactionMap & map )
+{
+    /// construct every element first, the links need their final address
+    for( size_t i = 0; i < other.m_vertices.size(); ++i )
+    {
+        if( map.vertices[i] == CompactionMap::removed ) continue;
+
+        const auto & vertex = other.m_vertices[i];
+        auto & copy = m_vertices.construct( map.vertices[i], map.vertices[i], vertex.position, vertex.color );
+        copy.light = vertex.light;
+        copy.initialized = true;
+    }
+
+    for( size_t i = 0; i < other.m_faces.size(); ++i )
+    {
+        if( map.faces[i] == CompactionMap::removed ) continue;
+
+        const auto & face = other.m_faces[i];
+        auto & copy = m_faces.construct( map.faces[i], map.faces[i], nullptr );
+        copy.normal = face.normal;
+        copy.color = face.color;
+        copy.initialized = true;
+    }
+
+    for( size_t i = 0; i < other.m_edges.size(); ++i )
+    {
+        if( map.edges[i] == CompactionMap::removed ) continue;
+
+        const auto & edge = other.m_edges[i];
+        auto & copy = m_edges.construct( map.edges[i], map.edges[i], edge.vertex ? &m_vertices[map.vertices[edge.vertex->id]] : nullptr );
+        copy.texcoord = edge.texcoord;
+        copy.barycenter = edge.barycenter;
+        copy.initialized = true;
+    }
+
+    auto remap_edge = [&]( const EdgeHandle edge ) -> EdgeHandle
+    {
+        return edge ? &m_edges[map.edges[edge->id]] : nullptr;
+    };
+
+    for( size_t i = 0; i < other.m_vertices.size(); ++i )
+    {
+        if( map.vertices[i] != CompactionMap::removed )
+        {
+            m_vertices[map.vertices[i]].edge = remap_edge( other.m_vertices[i].edge );
+        }
+    }
+
+    for( size_t i = 0; i < other.m_faces.size(); ++i )
+    {
+        if( map.faces[i] != CompactionMap::removed )
+        {
+            m_faces[map.faces[i]].edge = remap_edge( other.m_faces[i].edge );
+        }
+    }
+
+    for( size_t i = 0; i < other.m_edges.size(); ++i )
+    {
+        if( map.edges[i] == CompactionMap::removed ) continue;
+
+        const auto & edge = other.m_edges[i];
+        auto & copy = m_edges[map.edges[i]];
+        copy.next = remap_edge( edge.next );
+        copy.opposing = remap_edge( edge.opposing );
+        copy.face = edge.face ? &m_faces[map.faces[edge.face->id]] : nullptr;
+    }
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compute_normal( const FaceHandle face )
+{
+    touch_attributes_logged();
+
+    assert( face != nullptr );
+
+    const auto & p0 = face->edge->vertex->position;
+    const auto & p1 = face->edge->next->vertex->position;
+    const auto & p2 = face->edge->next->next->vertex->position;
+
+    auto vector1 = p0 - p1;
+    auto vector2 = p0 - p2;
+    face->normal = glm::normalize( glm::cross( vector1, vector2 ) );
+
+    log_face( face->id );
+    queue_dirty( face );
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compute_normals()
+{
+    touch_attributes_logged();
+
+    size_t i = 0;
+
+    compute_normals_batched( [&]() -> FaceHandle
+    {
+        /// next live face, nullptr once every face was handed out
+        for( ; i < m_faces.size(); ++i )
+        {
+            if( m_faces[i].edge != nullptr )
+            {
+                return &m_faces[i++];
+            }
+        }
+
+        return nullptr;
+    } );
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compute_normals( const std::vector<FaceHandle> & faces )
+{
+    touch_attributes_logged();
+
+    size_t i = 0;
+
+    compute_normals_batched( [&]() -> FaceHandle
+    {
+        return i < faces.size() ? faces[i++] : nullptr;
+    } );
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+template<typename NextFace>
+void LinkedMesh::compute_normals_batched( NextFace next_face )
+{
+    /// gather the first three corners of a batch of faces into SoA arrays, run the kernel, scatter
+    const size_t batch = normal_batch_size;
+    m_kernel_scratch.resize( batch * 12 );
+
+    FaceHandle faces[normal_batch_size];
+    float * corner = m_kernel_scratch.data();
+    float * normal = corner + batch * 9;
+
+    mesh_kernels::TriangleCorners corners;
+
+    for( int k = 0; k < 3; ++k )
+    {
+        corners.x[k] = corner + batch * ( k * 3 + 0 );
+        corners.y[k] = corner + batch * ( k * 3 + 1 );
+        corners.z[k] = corner + batch * ( k * 3 + 2 );
+    }
+
+    for( ;; )
+    {
+        size_t count = 0;
+
+        for( FaceHandle face; count < batch && ( face = next_face() ) != nullptr; ++count )
+        {
+            faces[count] = face;
+            auto edge = face->edge;
+
+            for( int k = 0; k < 3; ++k, edge = edge->next )
+            {
+                corner[batch * ( k * 3 + 0 ) + count] = edge->vertex->position[0];
+                corner[batch * ( k * 3 + 1 ) + count] = edge->vertex->position[1];
+                corner[batch * ( k * 3 + 2 ) + count] = edge->vertex->position[2];
+            }
+        }
+
+        if( count == 0 )
+        {
+            break;
+        }
+
+        mesh_kernels::triangle_normals( corners, normal, normal + batch, normal + batch * 2, count );
+
+        for( size_t i = 0; i < count; ++i )
+        {
+            faces[i]->normal = vec3( normal[i], normal[batch + i], normal[batch * 2 + i] );
+            log_face( faces[i]->id );
+            queue_dirty( faces[i] );
+        }
+    }
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compute_barycenter( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c, float & u, float & v, float & w )
+{
+    vec3 v0 = b - a, v1 = c - a, v2 = p - a;
+    float d00 = glm::dot( v0, v0 );
+    float d01 = glm::dot( v0, v1 );
+    float d11 = glm::dot( v1, v1 );
+    float d20 = glm::dot( v2, v0 );
+    float d21 = glm::dot( v2, v1 );
+    float denom = d00 * d11 - d01 * d01;
+    v = ( d11 * d20 - d01 * d21 ) / denom;
+    w = ( d00 * d21 - d01 * d20 ) / denom;
+    u = 1.0f - v - w;
+}
+
+/// /////////////////////////////////////////////////////////////////////////
+void LinkedMesh::compute_barycenters( const vec3 * points, const size_t count, const vec3 & a, const vec3 & b, const vec3 & c, float * u, float * v, float * w )
+{
+    /// transpose batches of points into SoA arrays for the kernel
+    const size_t batch = barycenter_batch_size;
+    m_kernel_scratch.resize( batch * 3 );
+
+    float * x = m_kernel_scratch.data();
+    float * y = x + batch;
+    float * z = y + batch;
+
+    for( size_t begin = 0; begin < count; begin += batch )
+    {
+        const auto size = std::min( batch, count - begin );
+
+        for( size_t i = 0; i < size; ++i )
+        {
+            x[i] = points[begin + i][0];
+            y[i] = points[begin + i][1];
+            z[i] = points[begin + i][2];
+        }
+
+        mesh_kernels::barycentric_coordinates( x, y, z, size, a, b, c, u + begin, v + begin, w + begin );
+    }
 }
@@ -1,16 +1,29 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
+#include <cstdint>
 #include <memory>
 #include <iostream>
+#include <limits>
+#include <string>
 
 #include "glm/glm.hpp"
 
 #include "vertex.hpp"
 #include "edge.hpp"
 #include "face.hpp"
+#include "circulators.hpp"
+#include "mesh_snapshot.hpp"
+#include "mesh_stats.hpp"
 
-#include "make_unique.hpp"
+#include "slab_pool.hpp"
+#include "scratch_arena.hpp"
+#include "parallel.hpp"
+
+class ExportCache;
+class MeshVersion;
+class MeshJournal;
 
 class LinkedMesh
 {
@@ -21,10 +34,51 @@ class LinkedMesh
       typedef Face* FaceHandle;
       typedef std::vector<EdgeHandle> EdgeLoop;
 
+      /// bytes of an export buffer changed by triangles_incremental
+      struct ExportRange
+      {
+         size_t offset;
+         size_t size;
+      };
+
+      /// how extrude_faces treats edges shared by two selected faces
+      enum class ExtrudeMode
+      {
+         /// every face is extruded on its own and gets walls on all of its edges
+         Individual,
+
+         /// the selection is extruded as one region, only its boundary edges get walls
+         Region
+      };
+
+      /// refinement scheme of subdivide
+      enum class Subdivision
+      {
+         /// any polygon mesh, every face is split into quads
+         CatmullClark,
+
+         /// triangle meshes, every triangle is split into four
+         Loop
+      };
+
+      /// new index of every element after compact(), by old index
+      struct CompactionMap
+      {
+         /// marks an element that was free and no longer exists
+         static const uint32_t removed = 0xFFFFFFFFu;
+
+         std::vector<uint32_t> vertices;
+         std::vector<uint32_t> edges;
+         std::vector<uint32_t> faces;
+      };
+
       LinkedMesh();
 
       ~LinkedMesh();
 
+      /// Preallocate storage so building up to this many elements does not allocate
+      void reserve( const size_t vertex_count, const size_t edge_count, const size_t face_count );
+
       /// Set the color of every vertex connected to this face
       void set_color( const FaceHandle face, const vec4 & color );
 
@@ -37,6 +91,10 @@ class LinkedMesh
       /// Allocate a new vertex
       VertexHandle add_vertex( const vec3 & position, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
       
+      /// Return a vertex no halfedge starts from to the free list. Callers move the halfedges off it
+      /// through handles, so for MeshJournal this is an edit through a handle and ends the change log
+      void release_vertex( const VertexHandle vertex );
+
       /// Allocate a new halfedge
       EdgeHandle add_halfedge( const VertexHandle vertex );
 
@@ -54,14 +112,22 @@ class LinkedMesh
       /// by lvalue reference example: EdgeLoop el; add_face(el)
       FaceHandle add_face( EdgeLoop & edges );
 
+      /// Add a face to the mesh from count unlinked halfedges, in loop order.
+      /// The other add_face overloads end here; this one does not allocate besides the face itself
+      FaceHandle add_face( const EdgeHandle * edges, const size_t count );
+
       inline void link_edges( const EdgeHandle edge_left , const EdgeHandle edge_right )
       {
          //assert( edge_left->next );
          //assert( edge_left->next->vertex->position == edge_right->vertex->position );
          //assert( edge_left->vertex->position == edge_right->next->vertex->position );
 
+         touch_logged();
+
          edge_left->opposing = edge_right;
          edge_right->opposing = edge_left;
+         log_edge( edge_left->id );
+         log_edge( edge_right->id );
       }
 
       /// bridge two edges by adding two new edges connecting them
@@ -73,29 +139,363 @@ class LinkedMesh
 
       FaceHandle extrude_face( const FaceHandle face, const vec3 & offset );
 
+      /// Move count faces by offset and connect them to where they were with quad walls.
+      /// Unlike extrude_face the faces themselves become the caps, so they may be linked to
+      /// neighbours and can be extruded again. Storage for all new elements is reserved up front
+      void extrude_faces( const FaceHandle * faces, const size_t count, const vec3 & offset, const ExtrudeMode mode = ExtrudeMode::Region );
+
+      /// Move faces by offset and connect them to where they were with quad walls
+      void extrude_faces( const std::vector<FaceHandle> & faces, const vec3 & offset, const ExtrudeMode mode = ExtrudeMode::Region );
+
       /// Fill buffers with mesh points
       void points( std::vector<float> & position_buffer, std::vector<float> & color_buffer );
 
       /// compute the normal for this face
       void compute_normal( const FaceHandle face );
 
+      /// compute the normal of every face, vectorized
+      void compute_normals();
+
+      /// compute the normals of a set of faces, vectorized
+      void compute_normals( const std::vector<FaceHandle> & faces );
+
       /// compute barycenter for triangle
       void compute_barycenter( const vec3 & p, const vec3 & a, const vec3 & b, const vec3 & c, float & u, float & v, float & w );
 
+      /// compute barycenters of count points for one triangle, vectorized
+      void compute_barycenters( const vec3 * points, const size_t count, const vec3 & a, const vec3 & b, const vec3 & c, float * u, float * v, float * w );
+
       /// Fill mesh vertex buffer
       void triangles( std::vector<Mesh::Vertex> & vertices );
 
       /// Fill buffers with mesh faces as triangles
       void triangles( std::vector<float> & position_buffer, std::vector<float> & color_buffer );
 
+      /// number of vertices triangles( vertices ) emits
+      size_t triangle_vertex_count() const;
+
+      /// number of floats triangles( position_buffer, color_buffer ) emits into each buffer
+      size_t triangle_float_count() const;
+
+      /// Fill caller provided memory with the mesh vertex buffer, without allocating. Returns the number of
+      /// vertices written; when capacity is below triangle_vertex_count() nothing is written and 0 returned
+      size_t triangles( Mesh::Vertex * vertices, const size_t capacity ) const;
+
+      /// Fill caller provided buffers with mesh faces as triangles, without allocating. Returns the number of
+      /// floats written per buffer; when capacity is below triangle_float_count() nothing is written and 0 returned
+      size_t triangles( float * position_buffer, float * color_buffer, const size_t capacity ) const;
+
+      /// Fill mesh vertex buffer on thread_count threads (0 uses every hardware thread)
+      /// the output is identical to triangles( vertices )
+      void triangles_parallel( std::vector<Mesh::Vertex> & vertices, const unsigned int thread_count = 0 );
+
+      /// Fill buffers with mesh faces as triangles on thread_count threads (0 uses every hardware thread)
+      /// the output is identical to triangles( position_buffer, color_buffer )
+      void triangles_parallel( std::vector<float> & position_buffer, std::vector<float> & color_buffer, const unsigned int thread_count = 0 );
+
+      /// Fill a vertex buffer with unique vertices and a triangle index buffer
+      /// corners of one vertex are only split where the face normal or texcoord differ.
+      /// Barycenters are per triangle and can not be shared, they are left zero
+      void triangles_indexed( std::vector<Mesh::Vertex> & vertices, std::vector<uint32_t> & indices );
+
+      /// mark a face for re-export by triangles_incremental
+      void mark_dirty( const FaceHandle face );
+
+      /// mark a vertex, every face using it is re-exported by triangles_incremental, including faces
+      /// in other fans of a non-manifold or pinch vertex. Costs the valence of the vertex; only
+      /// meshes that hold such split fans fall back to a pass over every halfedge at the next export
+      void mark_dirty( const VertexHandle vertex );
+
+      /// Update a vertex buffer filled by the previous call, re-emitting only faces changed since then
+      /// new faces are appended, a full export happens when faces were removed or reused.
+      /// Faces around dirty vertices are found through their one ring. When the topology changed since
+      /// the last check, one pass over the halfedges first finds out whether every fan is linked; if not,
+      /// dirty vertices cost a pass over the halfedges to find every face using them.
+      /// changed receives the sorted byte ranges of vertices that were written
+      void triangles_incremental( std::vector<Mesh::Vertex> & vertices, std::vector<ExportRange> & changed );
+
       /// clear vertices, edges and faces; deleting their allocations
       void clear();
 
       /// Unlink all vertices, edges and faces. Preparing the LinkedMesh for reuse
       void reset();
 
+      /// Move the live elements to the front of their arrays and release the free ones.
+      /// Invalidates every handle; the element with id i before is vertex( map.vertices[i] ),
+      /// edge( map.edges[i] ) or face( map.faces[i] ) afterwards
+      void compact( CompactionMap & map );
+
+      /// Simplify the mesh by quadric error edge collapses until target_face_count faces are left or the
+      /// cheapest collapse would cost more than max_error. Needs a welded and linked triangle mesh, as built
+      /// by LinkedMeshBuilder; collapses that would make it non manifold or flip a face are skipped.
+      /// Removed elements go to the free lists. Returns the number of collapses, 0 if a face is not a triangle
+      size_t decimate( const size_t target_face_count, const float max_error = std::numeric_limits<float>::max() );
+
+      /// Refine the mesh levels times on thread_count threads (0 uses every hardware thread). Each level is
+      /// sized up front and its topology built directly; open borders are kept as boundary curves.
+      /// Compacts the mesh, so every handle is invalidated. Returns false and leaves the mesh untouched when
+      /// a halfedge has no face, or for Loop when a face is not a triangle
+      bool subdivide( const Subdivision scheme, const unsigned int levels = 1, const unsigned int thread_count = 0 );
+
+      /// Copy the live elements of other to the end of this mesh, keeping their order and links.
+      /// The element with id i in other is vertex( map.vertices[i] ), edge( map.edges[i] ) or
+      /// face( map.faces[i] ) here. Halfedges are not linked across the two meshes, see LinkedMeshBuilder::stitch
+      void append( const LinkedMesh & other, CompactionMap & map );
+
+      /// Append every mesh of others in order, like append( *others[i], maps[i] ) for each of them. The ids
+      /// of all meshes are allotted first, then each mesh is copied and relinked into its own range on up to
+      /// thread_count threads (0 uses every hardware thread)
+      void append( const std::vector<const LinkedMesh *> & others, std::vector<CompactionMap> & maps, const unsigned int thread_count = 0 );
+
+      /// Write every element, free ones included, to a binary snapshot file. Returns false on io failure
+      bool save_snapshot( const std::string & path ) const;
+
+      /// Replace the mesh with a snapshot written by save_snapshot. The file is memory mapped and
+      /// read in place; ids and free lists are restored exactly. Returns false when the file is
+      /// missing, not a compatible snapshot, truncated or holds links that do not form valid face
+      /// loops of at least three halfedges; the mesh is left untouched in that case
+      bool load_snapshot( const std::string & path );
+
+      /// Immutable copy of the mesh for readers on other threads, see MeshVersion. Chunks whose records equal
+      /// the ones of previous are shared with it instead of copied; encoding runs on thread_count threads
+      std::shared_ptr<const MeshVersion> make_version( const MeshVersion * previous = nullptr, const unsigned int thread_count = 0 ) const;
+
+      /// halfedges of the face loop
+      inline FaceEdges edges( const FaceHandle face ) const { return FaceEdges( face ); }
+
+      /// faces across the linked edges of face
+      inline FaceNeighbours neighbours( const FaceHandle face ) const { return FaceNeighbours( face ); }
+
+      /// halfedges leaving vertex, in O(valence)
+      inline VertexOneRing one_ring( const VertexHandle vertex ) const { return VertexOneRing( vertex ); }
+
+      /// element by id
+      inline VertexHandle vertex( const size_t id ) { return &m_vertices[id]; }
+      inline EdgeHandle edge( const size_t id ) { return &m_edges[id]; }
+      inline FaceHandle face( const size_t id ) { return &m_faces[id]; }
+
+      /// allocated elements, including the ones on the free lists
+      inline size_t vertex_count() const { return m_vertices.size(); }
+      inline size_t edge_count() const { return m_edges.size(); }
+      inline size_t face_count() const { return m_faces.size(); }
+
+      /// bytes of heap memory held by the mesh: element slabs, free lists, dirty tracking and scratch
+      size_t allocated_bytes() const;
+
+      /// element counts, memory and, when built with LINKEDMESH_STATS, free list and timing counters
+      MeshStats stats() const;
+
+      /// zero the counters collected with LINKEDMESH_STATS
+      void reset_stats();
+
+      /// Counter bumped by every member that changes the mesh. Elements edited through their
+      /// handles are only noticed once mark_dirty is called for them
+      inline uint64_t revision() const { return m_revision; }
+
+      /// Exports of the mesh shared by all of its readers and rebuilt when the revision changes
+      ExportCache & export_cache();
+
    private:
 
+      /// the journal reads and rewrites the pools and free lists directly
+      friend class MeshJournal;
+
+      /// smallest share of faces worth a thread of its own
+      static const size_t parallel_faces_per_thread = 4096;
+
+      /// a member changed the mesh, cached exports of the previous revision are stale
+      inline void touch()
+      {
+         ++m_revision;
+         m_fans_checked = false;
+      }
+
+      /// a member changed attributes only, the connectivity is as before
+      inline void touch_attributes() { ++m_revision; }
+
+      /// Ids written by the logging mutators since MeshJournal started the log, so commit only compares
+      /// those. The log is complete while revision is the revision of the mesh: any change that is not
+      /// logged, an edit through a handle reported by mark_dirty included, leaves it behind for good
+      struct ChangeLog
+      {
+         /// ids [first, first + count)
+         struct Range
+         {
+            uint32_t first;
+            uint32_t count;
+         };
+
+         static const uint64_t stopped = std::numeric_limits<uint64_t>::max();
+
+         std::vector<Range> vertices;
+         std::vector<Range> edges;
+         std::vector<Range> faces;
+
+         /// shortest length of every free list since the start, the entries before it are unchanged
+         size_t kept_free_vertices = 0;
+         size_t kept_free_edges = 0;
+         size_t kept_free_faces = 0;
+
+         /// revision when the log was started and after its last logged change
+         uint64_t start = stopped;
+         uint64_t revision = stopped;
+      };
+
+      /// a logging mutator changed the mesh, the change log stays complete if it was
+      inline void touch_logged()
+      {
+         const bool logging = this->logging();
+         touch();
+
+         if( logging ) m_change_log.revision = m_revision;
+      }
+
+      inline void touch_attributes_logged()
+      {
+         const bool logging = this->logging();
+         touch_attributes();
+
+         if( logging ) m_change_log.revision = m_revision;
+      }
+
+      inline bool logging() const { return m_change_log.revision == m_revision; }
+
+      /// add ids to a log, runs of consecutive or repeated ids share one range
+      static inline void log_ids( std::vector<ChangeLog::Range> & ranges, const uint32_t first, const uint32_t count )
+      {
+         if( !ranges.empty() )
+         {
+            auto & last = ranges.back();
+
+            if( first >= last.first && first <= last.first + last.count )
+            {
+               last.count = std::max( last.count, first + count - last.first );
+               return;
+            }
+         }
+
+         ranges.push_back( { first, count } );
+      }
+
+      inline void log_vertex( const uint32_t id ) { if( logging() ) log_ids( m_change_log.vertices, id, 1 ); }
+      inline void log_edge( const uint32_t id ) { if( logging() ) log_ids( m_change_log.edges, id, 1 ); }
+      inline void log_face( const uint32_t id ) { if( logging() ) log_ids( m_change_log.faces, id, 1 ); }
+
+      /// every element, for mutators that visit all of them
+      inline void log_all()
+      {
+         if( !logging() ) return;
+
+         log_ids( m_change_log.vertices, 0, static_cast<uint32_t>( m_vertices.size() ) );
+         log_ids( m_change_log.edges, 0, static_cast<uint32_t>( m_edges.size() ) );
+         log_ids( m_change_log.faces, 0, static_cast<uint32_t>( m_faces.size() ) );
+      }
+
+      /// queue the faces of a vertex for triangles_incremental like mark_dirty, without changing the revision
+      void queue_dirty_vertex( const VertexHandle vertex );
+
+      /// whether some vertex has faces outside the fan its one ring walks, e.g. at unlinked non manifold
+      /// edges or welded pinch vertices. Found with one pass over the halfedges after every topology change
+      bool has_split_fans();
+
+      /// queue the faces around a vertex whose fan reaches all of them
+      inline void queue_dirty( const VertexHandle vertex )
+      {
+         if( vertex->edge == nullptr ) return;
+
+         for( const auto edge : one_ring( vertex ) )
+         {
+            if( edge->face != nullptr )
+            {
+               queue_dirty( edge->face );
+            }
+         }
+      }
+
+      /// queue a face for re-export by triangles_incremental without changing the revision
+      inline void queue_dirty( const FaceHandle face )
+      {
+         if( !face->dirty )
+         {
+            face->dirty = true;
+            m_dirty_faces.push_back( face );
+         }
+      }
+
+      /// return an element to its free list, links are cleared. Logged, without changing the revision
+      void free_vertex( const VertexHandle vertex );
+      void release_edge( const EdgeHandle edge );
+      void release_face( const FaceHandle face );
+
+      /// one level of subdivide, on a mesh that was checked for the scheme
+      void subdivide_level( const Subdivision scheme, const unsigned int thread_count );
+
+      /// extrude a set of faces as one region
+      void extrude_region( const FaceHandle * faces, const size_t count, const vec3 & offset );
+
+      /// convert an element to its snapshot record, links become indices
+      void store( const Vertex & vertex, mesh_snapshot::VertexRecord & record ) const;
+      void store( const Edge & edge, mesh_snapshot::EdgeRecord & record ) const;
+      void store( const Face & face, mesh_snapshot::FaceRecord & record ) const;
+
+      /// overwrite an element from its snapshot record, every linked index must already be allocated
+      void restore( Vertex & vertex, const mesh_snapshot::VertexRecord & record );
+      void restore( Edge & edge, const mesh_snapshot::EdgeRecord & record );
+      void restore( Face & face, const mesh_snapshot::FaceRecord & record );
+
+      /// faces gathered per normal kernel call
+      static const size_t normal_batch_size = 256;
+
+      /// points transposed per barycenter kernel call
+      static const size_t barycenter_batch_size = 1024;
+
+      /// run the normal kernel over the faces returned by next_face until it returns nullptr
+      template<typename NextFace>
+      void compute_normals_batched( NextFace next_face );
+
+      /// number of edges in the edgeloop of face
+      static inline size_t edge_count( const Face & face )
+      {
+         size_t count = 0;
+         auto edge = face.edge;
+
+         do
+         {
+            ++count;
+         }
+         while( ( edge = edge->next ) != face.edge );
+
+         return count;
+      }
+
+      /// number of vertices triangles( vertices ) emits for face
+      static inline size_t triangle_vertex_count( const Face & face )
+      {
+         const auto count = edge_count( face );
+         return count + count / 3 + 1;
+      }
+
+      /// number of corners triangles( position_buffer, color_buffer ) emits for face
+      static inline size_t triangle_corner_count( const Face & face )
+      {
+         return ( edge_count( face ) - 2 ) * 3;
+      }
+
+      /// write the vertices of every face, the buffer must hold triangle_vertex_count()
+      size_t write_all_triangles( Mesh::Vertex * vertices ) const;
+
+      /// write the triangle corners of every face, the buffers must hold triangle_float_count()
+      size_t write_all_triangles( float * position_buffer, float * color_buffer ) const;
+
+      /// construct the live elements of other in the slots map points at, grown by the caller, and link them
+      void copy_elements( const LinkedMesh & other, const CompactionMap & map );
+
+      /// write the vertices of one face, returns the number of vertices written
+      static size_t write_triangles( const Face & face, Mesh::Vertex * vertices );
+
+      /// write the triangle corners of one face, returns the number of floats written per buffer
+      static size_t write_triangles( const Face & face, float * position_buffer, float * color_buffer );
+
       /// indices of vertices which were allocated but removed from the mesh and free for reuse
       std::vector<int> m_free_vertices;
 
@@ -105,12 +505,63 @@ class LinkedMesh
       /// indices of faces which that were allocated but removed from the mesh and free for reuse
       std::vector<int> m_free_faces;
 
-      /// allocated vertices
-      std::vector<std::unique_ptr<Vertex>> m_vertices;
+      /// faces changed since the last triangles_incremental
+      std::vector<FaceHandle> m_dirty_faces;
+
+      /// vertices changed since the last triangles_incremental
+      std::vector<VertexHandle> m_dirty_vertices;
+
+      /// first vertex of every face in the last triangles_incremental output, plus its end
+      std::vector<size_t> m_export_offsets;
+
+      /// a region boundary edge collected by extrude_region
+      struct ExtrudeBoundary
+      {
+         EdgeHandle edge;
+         VertexHandle vertex0;
+         VertexHandle vertex1;
+         EdgeHandle opposing;
+         EdgeHandle side;
+      };
+
+      /// extrude_region scratch, kept between calls so extrusion does not allocate once warm
+      std::vector<uint8_t> m_face_mark;
+      std::vector<VertexHandle> m_vertex_map;
+      std::vector<ExtrudeBoundary> m_extrude_boundary;
+      std::vector<VertexHandle> m_extrude_corners;
+      std::vector<VertexHandle> m_extrude_orphans;
+
+      /// SoA staging memory of the batch kernels
+      std::vector<float> m_kernel_scratch;
+
+      /// temporaries of topology operations, each operation opens a ScratchArena::Scope
+      ScratchArena m_scratch;
+
+      /// instrumentation counters, only updated when built with LINKEDMESH_STATS
+      mutable MeshStats::Counters m_stats;
+
+      /// m_export_offsets still matches the faces, so changes can be patched in place
+      bool m_export_layout_valid = false;
+
+      /// see revision()
+      uint64_t m_revision = 0;
+
+      /// see ChangeLog
+      ChangeLog m_change_log;
+
+      /// see has_split_fans(), m_split_fans is only valid while m_fans_checked
+      bool m_fans_checked = false;
+      bool m_split_fans = false;
+
+      /// see export_cache()
+      std::unique_ptr<ExportCache> m_export_cache;
+
+      /// allocated vertices, stored in slabs so handles stay valid while the mesh grows
+      SlabPool<Vertex> m_vertices;
 
       /// allocated edges
-      std::vector<std::unique_ptr<Edge>> m_edges;
+      SlabPool<Edge> m_edges;
 
       /// allocated faces
-      std::vector<std::unique_ptr<Face>> m_faces;
+      SlabPool<Face> m_faces;
 };
@@ -0,0 +1,384 @@
+#include "core/mesh/LinkedMeshBuilder.hpp"
+
+#include <cmath>
+
+namespace
+{
+    const uint32_t end_of_cell = 0xFFFFFFFFu;
+
+    /// smallest share of appended halfedges worth a thread of its own in stitch
+    const size_t parallel_edges_per_thread = 16384;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::LinkedMeshBuilder( LinkedMesh & mesh, const float weld_epsilon ) :
+    m_mesh( mesh ),
+    m_weld_epsilon( weld_epsilon ),
+    m_cell_size( weld_epsilon > 0.0f ? weld_epsilon : 1.0f )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::~LinkedMeshBuilder()
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMeshBuilder::reserve( const size_t vertex_count, const size_t face_count )
+{
+    /// assume a closed quad dominant mesh, one halfedge per face corner
+    const size_t edge_count = face_count * 4;
+
+    m_mesh.reserve( vertex_count, edge_count, face_count );
+    m_cells.reserve( vertex_count );
+    m_cell_entries.reserve( vertex_count );
+    m_open_edges.reserve( edge_count / 2 );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::CellKey LinkedMeshBuilder::cell_of( const vec3 & position ) const
+{
+    CellKey key;
+    key.x = static_cast<int64_t>( std::floor( position[0] / m_cell_size ) );
+    key.y = static_cast<int64_t>( std::floor( position[1] / m_cell_size ) );
+    key.z = static_cast<int64_t>( std::floor( position[2] / m_cell_size ) );
+    return key;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::VertexHandle LinkedMeshBuilder::weld_vertex( const vec3 & position, const vec4 & color )
+{
+    const auto found = find_vertex( position );
+
+    if( found != nullptr )
+    {
+        return found;
+    }
+
+    const auto vertex = m_mesh.add_vertex( position, color );
+    insert_vertex( vertex );
+    return vertex;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::VertexHandle LinkedMeshBuilder::find_vertex( const vec3 & position ) const
+{
+    const auto cell = cell_of( position );
+    const float epsilon_squared = m_weld_epsilon * m_weld_epsilon;
+
+    /// the cells are as wide as epsilon, so a match can only be in the 27 cells around position
+    for( int64_t dx = -1; dx <= 1; ++dx )
+    {
+        for( int64_t dy = -1; dy <= 1; ++dy )
+        {
+            for( int64_t dz = -1; dz <= 1; ++dz )
+            {
+                const CellKey neighbour = { cell.x + dx, cell.y + dy, cell.z + dz };
+                const auto found = m_cells.find( neighbour );
+
+                if( found == m_cells.end() )
+                {
+                    continue;
+                }
+
+                for( auto entry = found->second; entry != end_of_cell; entry = m_cell_entries[entry].next )
+                {
+                    const auto vertex = m_cell_entries[entry].vertex;
+                    const auto delta = vertex->position - position;
+
+                    if( glm::dot( delta, delta ) <= epsilon_squared )
+                    {
+                        return vertex;
+                    }
+                }
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMeshBuilder::insert_vertex( const VertexHandle vertex )
+{
+    /// push the vertex at the front of its cell chain
+    const auto head = m_cells.emplace( cell_of( vertex->position ), end_of_cell ).first;
+    m_cell_entries.push_back( { vertex, head->second } );
+    head->second = static_cast<uint32_t>( m_cell_entries.size() - 1 );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::FaceHandle LinkedMeshBuilder::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec4 & color )
+{
+    m_corners.clear();
+    m_corners.push_back( weld_vertex( p0, color ) );
+    m_corners.push_back( weld_vertex( p1, color ) );
+    m_corners.push_back( weld_vertex( p2, color ) );
+
+    const auto face = add_face( m_corners.data(), m_corners.size() );
+    face->color = color;
+    return face;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::FaceHandle LinkedMeshBuilder::add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec3 & p3, const vec4 & color )
+{
+    m_corners.clear();
+    m_corners.push_back( weld_vertex( p0, color ) );
+    m_corners.push_back( weld_vertex( p1, color ) );
+    m_corners.push_back( weld_vertex( p2, color ) );
+    m_corners.push_back( weld_vertex( p3, color ) );
+
+    const auto face = add_face( m_corners.data(), m_corners.size() );
+    face->color = color;
+    return face;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::FaceHandle LinkedMeshBuilder::add_face( const std::vector<vec3> & positions, const vec4 & color )
+{
+    m_corners.clear();
+
+    for( const auto & position : positions )
+    {
+        m_corners.push_back( weld_vertex( position, color ) );
+    }
+
+    const auto face = add_face( m_corners.data(), m_corners.size() );
+    face->color = color;
+    return face;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+LinkedMeshBuilder::FaceHandle LinkedMeshBuilder::add_face( const VertexHandle * vertices, const size_t count )
+{
+    assert( count > 2 );
+
+    m_edge_loop.clear();
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        m_edge_loop.push_back( m_mesh.add_halfedge( vertices[i] ) );
+    }
+
+    const auto face = m_mesh.add_face( m_edge_loop );
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        pair_edge( m_edge_loop[i], vertices[i], vertices[( i+1 )%count] );
+    }
+
+    return face;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMeshBuilder::pair_edge( const EdgeHandle edge, const VertexHandle from, const VertexHandle to )
+{
+    /// a halfedge from -> to pairs with the open halfedge to -> from
+    const auto opposing = m_open_edges.find( edge_key( to, from ) );
+
+    if( opposing != m_open_edges.end() )
+    {
+        m_mesh.link_edges( edge, opposing->second );
+        m_open_edges.erase( opposing );
+    }
+    else
+    {
+        /// a second from -> to halfedge is non manifold, it stays unlinked
+        m_open_edges.emplace( edge_key( from, to ), edge );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMeshBuilder::stitch()
+{
+    m_cells.clear();
+    m_cell_entries.clear();
+    m_open_edges.clear();
+
+    std::vector<EdgeHandle> open_edges;
+
+    for( size_t i = 0; i < m_mesh.edge_count(); ++i )
+    {
+        const auto edge = m_mesh.edge( i );
+
+        if( edge->initialized && edge->face != nullptr && edge->opposing == nullptr )
+        {
+            open_edges.push_back( edge );
+        }
+    }
+
+    /// the first vertex found at a position represents every vertex welded to it
+    std::vector<VertexHandle> welded( m_mesh.vertex_count(), nullptr );
+
+    auto weld = [&]( const VertexHandle vertex )
+    {
+        auto & target = welded[vertex->id];
+
+        if( target == nullptr )
+        {
+            target = find_vertex( vertex->position );
+
+            if( target == nullptr )
+            {
+                insert_vertex( vertex );
+                target = vertex;
+            }
+        }
+    };
+
+    for( const auto edge : open_edges )
+    {
+        weld( edge->vertex );
+        weld( edge->next->vertex );
+    }
+
+    /// move every halfedge, interior ones included, off the vertices that were welded away
+    for( size_t i = 0; i < m_mesh.edge_count(); ++i )
+    {
+        const auto edge = m_mesh.edge( i );
+
+        if( edge->initialized && edge->vertex != nullptr )
+        {
+            const auto target = welded[edge->vertex->id];
+
+            if( target != nullptr )
+            {
+                edge->vertex = target;
+            }
+        }
+    }
+
+    for( size_t i = 0; i < welded.size(); ++i )
+    {
+        if( welded[i] != nullptr && welded[i] != m_mesh.vertex( i ) )
+        {
+            m_mesh.release_vertex( m_mesh.vertex( i ) );
+        }
+    }
+
+    const auto open_before = open_edges.size();
+
+    for( const auto edge : open_edges )
+    {
+        pair_edge( edge, edge->vertex, edge->next->vertex );
+    }
+
+    return ( open_before - m_open_edges.size() ) / 2;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMeshBuilder::stitch( const std::vector<EdgeHandle> & frontier, const size_t first_vertex, const size_t first_edge, const unsigned int thread_count )
+{
+    m_cells.clear();
+    m_cell_entries.clear();
+    m_open_edges.clear();
+
+    std::vector<EdgeHandle> open_edges( frontier );
+
+    /// the frontier vertices represent their positions, nothing before first_vertex is welded away
+    for( const auto edge : frontier )
+    {
+        assert( edge->id < first_edge && edge->face != nullptr && edge->opposing == nullptr );
+
+        const VertexHandle corners[] = { edge->vertex, edge->next->vertex };
+
+        for( const auto vertex : corners )
+        {
+            if( find_vertex( vertex->position ) == nullptr )
+            {
+                insert_vertex( vertex );
+            }
+        }
+    }
+
+    /// the passes over the appended halfedges split into blocks, open ones are joined in block order
+    const auto appended = m_mesh.edge_count() - first_edge;
+    const auto threads = parallel_thread_count( appended, thread_count, parallel_edges_per_thread );
+    std::vector<std::vector<EdgeHandle>> block_open_edges( threads );
+
+    parallel_for_blocks( appended, threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        for( size_t i = first_edge + begin; i < first_edge + end; ++i )
+        {
+            const auto edge = m_mesh.edge( i );
+
+            if( edge->initialized && edge->face != nullptr && edge->opposing == nullptr )
+            {
+                block_open_edges[block].push_back( edge );
+            }
+        }
+    } );
+
+    for( const auto & edges : block_open_edges )
+    {
+        open_edges.insert( open_edges.end(), edges.begin(), edges.end() );
+    }
+
+    /// target of every appended vertex, by id - first_vertex
+    std::vector<VertexHandle> welded( m_mesh.vertex_count() - first_vertex, nullptr );
+
+    auto weld = [&]( const VertexHandle vertex )
+    {
+        if( vertex->id < first_vertex ) return;
+
+        auto & target = welded[vertex->id - first_vertex];
+
+        if( target == nullptr )
+        {
+            target = find_vertex( vertex->position );
+
+            if( target == nullptr )
+            {
+                insert_vertex( vertex );
+                target = vertex;
+            }
+        }
+    };
+
+    for( size_t i = frontier.size(); i < open_edges.size(); ++i )
+    {
+        weld( open_edges[i]->vertex );
+        weld( open_edges[i]->next->vertex );
+    }
+
+    /// only appended halfedges start at appended vertices
+    parallel_for_blocks( appended, threads, [&]( const unsigned int, const size_t begin, const size_t end )
+    {
+        for( size_t i = first_edge + begin; i < first_edge + end; ++i )
+        {
+            const auto edge = m_mesh.edge( i );
+
+            if( edge->initialized && edge->vertex != nullptr && edge->vertex->id >= first_vertex )
+            {
+                const auto target = welded[edge->vertex->id - first_vertex];
+
+                if( target != nullptr )
+                {
+                    edge->vertex = target;
+                }
+            }
+        }
+    } );
+
+    for( size_t i = 0; i < welded.size(); ++i )
+    {
+        const auto vertex = m_mesh.vertex( first_vertex + i );
+
+        if( welded[i] != nullptr && welded[i] != vertex )
+        {
+            m_mesh.release_vertex( vertex );
+        }
+    }
+
+    const auto open_before = open_edges.size();
+
+    for( const auto edge : open_edges )
+    {
+        pair_edge( edge, edge->vertex, edge->next->vertex );
+    }
+
+    return ( open_before - m_open_edges.size() ) / 2;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+
+/// Bulk face builder for LinkedMesh.
+/// Corners closer than the weld epsilon share one Vertex (found through a spatial hash)
+/// and every new halfedge is paired with its opposing halfedge through a (from,to) edge hash,
+/// so the result can be used with bridge_edges and extrude_* without calling link_edges by hand.
+/// Building n faces takes O(n) expected time.
+class LinkedMeshBuilder
+{
+   public:
+
+      typedef LinkedMesh::VertexHandle VertexHandle;
+      typedef LinkedMesh::EdgeHandle EdgeHandle;
+      typedef LinkedMesh::FaceHandle FaceHandle;
+
+      /// positions closer than weld_epsilon are merged, 0 only merges identical positions
+      LinkedMeshBuilder( LinkedMesh & mesh, const float weld_epsilon = 1e-5f );
+
+      ~LinkedMeshBuilder();
+
+      /// Preallocate the mesh and the hash tables for the expected element count
+      void reserve( const size_t vertex_count, const size_t face_count );
+
+      /// Return the vertex within weld epsilon of position, or add a new one
+      VertexHandle weld_vertex( const vec3 & position, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Return a vertex known to the builder within weld epsilon of position, nullptr if there is none
+      VertexHandle find_vertex( const vec3 & position ) const;
+
+      /// Add a welded and linked face from 3 points and 1 color
+      FaceHandle add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Add a welded and linked face from 4 points and 1 color
+      FaceHandle add_face( const vec3 & p0, const vec3 & p1, const vec3 & p2, const vec3 & p3, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Add a welded and linked face from a polygon
+      FaceHandle add_face( const std::vector<vec3> & positions, const vec4 & color = vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+      /// Add a linked face from vertices of the mesh, pairing its halfedges with the ones already built
+      FaceHandle add_face( const VertexHandle * vertices, const size_t count );
+
+      /// Weld the vertices of every open halfedge of the mesh and link the open halfedges that meet,
+      /// e.g. along the seams of meshes combined with LinkedMesh::append. Vertices merged into another
+      /// one are released to the free list. Elements are visited by id, so the result is deterministic.
+      /// Rebuilds the hash tables from the open halfedges; returns the number of pairs linked
+      size_t stitch();
+
+      /// Stitch the elements appended at the end of the mesh, vertices from id first_vertex and halfedges
+      /// from id first_edge on, to each other and to the open halfedges of frontier, which lie before them.
+      /// Works like stitch() but only visits the appended elements and the frontier, so its cost does not
+      /// grow with the rest of the mesh. Frontier vertices are kept, appended vertices are welded onto them
+      /// and released when they are. The passes over the appended halfedges run on up to thread_count threads
+      /// (0 uses every hardware thread), welding and linking stay serial. Returns the number of pairs linked
+      size_t stitch( const std::vector<EdgeHandle> & frontier, const size_t first_vertex, const size_t first_edge, const unsigned int thread_count = 1 );
+
+      /// number of halfedges still waiting for an opposing halfedge
+      inline size_t open_edge_count() const { return m_open_edges.size(); }
+
+   private:
+
+      struct CellKey
+      {
+         int64_t x, y, z;
+
+         bool operator==( const CellKey & other ) const { return x == other.x && y == other.y && z == other.z; }
+      };
+
+      struct CellHash
+      {
+         size_t operator()( const CellKey & key ) const
+         {
+            uint64_t hash = static_cast<uint64_t>( key.x ) * 0x9E3779B97F4A7C15ull;
+            hash ^= static_cast<uint64_t>( key.y ) * 0xC2B2AE3D27D4EB4Full + ( hash << 6 ) + ( hash >> 2 );
+            hash ^= static_cast<uint64_t>( key.z ) * 0x165667B19E3779F9ull + ( hash << 6 ) + ( hash >> 2 );
+            return static_cast<size_t>( hash );
+         }
+      };
+
+      /// a welded vertex in a cell, chained to the next vertex in the same cell
+      struct CellEntry
+      {
+         VertexHandle vertex;
+         uint32_t next;
+      };
+
+      CellKey cell_of( const vec3 & position ) const;
+
+      /// add an existing vertex to the spatial hash
+      void insert_vertex( const VertexHandle vertex );
+
+      /// pair a new halfedge from -> to with an open halfedge to -> from, or leave it open
+      void pair_edge( const EdgeHandle edge, const VertexHandle from, const VertexHandle to );
+
+      /// key of the directed edge from -> to in m_open_edges
+      static inline uint64_t edge_key( const VertexHandle from, const VertexHandle to )
+      {
+         return ( static_cast<uint64_t>( from->id ) << 32 ) | to->id;
+      }
+
+      LinkedMesh & m_mesh;
+
+      float m_weld_epsilon;
+
+      float m_cell_size;
+
+      /// first entry of every occupied cell
+      std::unordered_map<CellKey, uint32_t, CellHash> m_cells;
+
+      /// entries of all cells, chained through CellEntry::next
+      std::vector<CellEntry> m_cell_entries;
+
+      /// halfedges without opposing halfedge, by (from,to) vertex id
+      std::unordered_map<uint64_t, EdgeHandle> m_open_edges;
+
+      /// reused edge loop, avoids an allocation per face
+      LinkedMesh::EdgeLoop m_edge_loop;
+
+      /// reused corner list of the positional add_face overloads
+      std::vector<VertexHandle> m_corners;
+};
@@ -0,0 +1,496 @@
+#include "core/mesh/LinkedMesh.hpp"
+#include "core/mesh/indexed_heap.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /// symmetric 4x4 error quadric of Garland and Heckbert, upper triangle in row order
+    struct Quadric
+    {
+        double q[10] = {};
+
+        /// add the squared distance to the plane n.p + d = 0, scaled by weight
+        void add_plane( const vec3 & n, const double d, const double weight )
+        {
+            const double a = n[0], b = n[1], c = n[2];
+
+            q[0] += weight * a * a; q[1] += weight * a * b; q[2] += weight * a * c; q[3] += weight * a * d;
+            q[4] += weight * b * b; q[5] += weight * b * c; q[6] += weight * b * d;
+            q[7] += weight * c * c; q[8] += weight * c * d;
+            q[9] += weight * d * d;
+        }
+
+        Quadric & operator+=( const Quadric & other )
+        {
+            for( int i = 0; i < 10; ++i )
+            {
+                q[i] += other.q[i];
+            }
+
+            return *this;
+        }
+
+        double error( const vec3 & p ) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+
+            return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+                 + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+                 + q[7] * z * z + 2.0 * q[8] * z
+                 + q[9];
+        }
+
+        /// the point of least error, false when the quadric is singular
+        bool optimum( vec3 & p ) const
+        {
+            /// solve A p = -b with A the upper left 3x3 block by Cramer's rule
+            const double a00 = q[0], a01 = q[1], a02 = q[2];
+            const double a11 = q[4], a12 = q[5], a22 = q[7];
+            const double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+
+            const double c00 = a11 * a22 - a12 * a12;
+            const double c01 = a02 * a12 - a01 * a22;
+            const double c02 = a01 * a12 - a02 * a11;
+            const double det = a00 * c00 + a01 * c01 + a02 * c02;
+
+            const double scale = std::max( std::max( std::fabs( a00 ), std::fabs( a11 ) ), std::fabs( a22 ) );
+
+            if( std::fabs( det ) <= 1e-9 * scale * scale * scale )
+            {
+                return false;
+            }
+
+            const double c11 = a00 * a22 - a02 * a02;
+            const double c12 = a01 * a02 - a00 * a12;
+            const double c22 = a00 * a11 - a01 * a01;
+
+            p = vec3( ( c00 * b0 + c01 * b1 + c02 * b2 ) / det,
+                      ( c01 * b0 + c11 * b1 + c12 * b2 ) / det,
+                      ( c02 * b0 + c12 * b1 + c22 * b2 ) / det );
+            return true;
+        }
+    };
+
+    /// weight of the planes holding open borders in place, relative to the faces
+    const double boundary_weight = 100.0;
+
+    /// a collapse is skipped when it turns a remaining face normal by more than about 80 degrees
+    const float min_normal_dot = 0.2f;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t LinkedMesh::decimate( const size_t target_face_count, const float max_error )
+{
+    size_t face_count = 0;
+
+    for( const auto & face : m_faces )
+    {
+        if( !face.initialized ) continue;
+
+        if( edge_count( face ) != 3 )
+        {
+            return 0;
+        }
+
+        ++face_count;
+    }
+
+    /// sum the planes of the faces around every vertex, plus planes across open edges
+    std::vector<Quadric> quadrics( m_vertices.size() );
+
+    for( const auto & face : m_faces )
+    {
+        if( !face.initialized ) continue;
+
+        const auto & p0 = face.edge->vertex->position;
+        const auto & p1 = face.edge->next->vertex->position;
+        const auto & p2 = face.edge->next->next->vertex->position;
+
+        const auto cross = glm::cross( p1 - p0, p2 - p0 );
+        const auto length = glm::length( cross );
+
+        if( length <= 0.0f ) continue;
+
+        const auto normal = cross / length;
+        const double d = -glm::dot( normal, p0 );
+
+        for( auto edge : edges( &m_faces[face.id] ) )
+        {
+            quadrics[edge->vertex->id].add_plane( normal, d, 0.5 * length );
+
+            if( edge->opposing == nullptr )
+            {
+                const auto & from = edge->vertex->position;
+                const auto direction = edge->next->vertex->position - from;
+                const auto side = glm::cross( direction, normal );
+                const auto side_length = glm::length( side );
+
+                if( side_length > 0.0f )
+                {
+                    const auto side_normal = side / side_length;
+                    const double side_d = -glm::dot( side_normal, from );
+                    const double weight = boundary_weight * glm::dot( direction, direction );
+
+                    quadrics[edge->vertex->id].add_plane( side_normal, side_d, weight );
+                    quadrics[edge->next->vertex->id].add_plane( side_normal, side_d, weight );
+                }
+            }
+        }
+    }
+
+    /// one heap entry per undirected edge, stored under the halfedge with the lower id
+    auto is_key = []( const EdgeHandle edge )
+    {
+        return edge->opposing == nullptr || edge->id < edge->opposing->id;
+    };
+
+    auto key_of = [&]( const EdgeHandle edge )
+    {
+        return is_key( edge ) ? edge : edge->opposing;
+    };
+
+    IndexedHeap heap;
+    heap.reserve( m_edges.size() );
+
+    std::vector<vec3> targets( m_edges.size() );
+
+    /// costs are updated lazily: an entry computed before one of its vertices moved is
+    /// recomputed when it reaches the top of the heap
+    std::vector<uint32_t> edge_stamps( m_edges.size(), 0 );
+    std::vector<uint32_t> vertex_stamps( m_vertices.size(), 0 );
+    uint32_t stamp = 0;
+
+    auto evaluate = [&]( const EdgeHandle edge )
+    {
+        const auto v0 = edge->vertex;
+        const auto v1 = edge->next->vertex;
+
+        Quadric quadric = quadrics[v0->id];
+        quadric += quadrics[v1->id];
+
+        vec3 candidates[4] = { ( v0->position + v1->position ) * 0.5f, v0->position, v1->position, vec3() };
+        const int candidate_count = quadric.optimum( candidates[3] ) ? 4 : 3;
+
+        int best = 0;
+        double best_error = quadric.error( candidates[0] );
+
+        for( int i = 1; i < candidate_count; ++i )
+        {
+            const double error = quadric.error( candidates[i] );
+
+            if( error < best_error )
+            {
+                best = i;
+                best_error = error;
+            }
+        }
+
+        targets[edge->id] = candidates[best];
+        edge_stamps[edge->id] = stamp;
+        heap.update( edge->id, static_cast<float>( std::max( 0.0, best_error ) ) );
+    };
+
+    for( auto & edge : m_edges )
+    {
+        if( edge.initialized && edge.face != nullptr && is_key( &edge ) )
+        {
+            evaluate( &edge );
+        }
+    }
+
+    /// per vertex marks of the link condition, a new mark value per test
+    std::vector<uint32_t> marks( m_vertices.size(), 0 );
+    uint32_t mark = 0;
+
+    /// reused outgoing halfedges of the removed vertex
+    std::vector<EdgeHandle> ring;
+    ring.reserve( 64 );
+
+    auto is_boundary = [&]( const VertexHandle vertex )
+    {
+        for( const auto edge : one_ring( vertex ) )
+        {
+            if( edge->opposing == nullptr || edge->next->next->opposing == nullptr )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto face_count_around = [&]( const VertexHandle vertex )
+    {
+        size_t count = 0;
+
+        for( const auto edge : one_ring( vertex ) )
+        {
+            ( void )edge;
+            ++count;
+        }
+
+        return count;
+    };
+
+    /// a face around v0 or v1 turns too far when they move to target
+    auto flips = [&]( const VertexHandle vertex, const VertexHandle v0, const VertexHandle v1, const vec3 & target, const FaceHandle f0, const FaceHandle f1 )
+    {
+        for( const auto edge : one_ring( vertex ) )
+        {
+            if( edge->face == f0 || edge->face == f1 ) continue;
+
+            vec3 before[3], after[3];
+            auto corner = edge;
+
+            for( int i = 0; i < 3; ++i, corner = corner->next )
+            {
+                before[i] = corner->vertex->position;
+                after[i] = corner->vertex == v0 || corner->vertex == v1 ? target : before[i];
+            }
+
+            const auto normal_before = glm::cross( before[1] - before[0], before[2] - before[0] );
+            const auto normal_after = glm::cross( after[1] - after[0], after[2] - after[0] );
+            const auto length_before = glm::length( normal_before );
+            const auto length_after = glm::length( normal_after );
+
+            if( length_after <= 0.0f )
+            {
+                return true;
+            }
+
+            if( length_before > 0.0f && glm::dot( normal_before, normal_after ) < min_normal_dot * length_before * length_after )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto can_collapse = [&]( const EdgeHandle edge )
+    {
+        const auto opposing = edge->opposing;
+        const auto v0 = edge->vertex;
+        const auto v1 = edge->next->vertex;
+        const auto a = edge->next->next->vertex;
+        const auto b = opposing ? opposing->next->next->vertex : nullptr;
+
+        /// a removed face with two open outer edges would leave its third vertex dangling
+        if( edge->next->opposing == nullptr && edge->next->next->opposing == nullptr )
+        {
+            return false;
+        }
+
+        if( opposing && opposing->next->opposing == nullptr && opposing->next->next->opposing == nullptr )
+        {
+            return false;
+        }
+
+        /// link condition: v0 and v1 may only share the neighbours across the removed faces
+        ++mark;
+
+        for( const auto ring_edge : one_ring( v0 ) )
+        {
+            marks[ring_edge->next->vertex->id] = mark;
+            marks[ring_edge->next->next->vertex->id] = mark;
+        }
+
+        for( const auto ring_edge : one_ring( v1 ) )
+        {
+            for( const auto neighbour : { ring_edge->next->vertex, ring_edge->next->next->vertex } )
+            {
+                if( neighbour != v0 && neighbour != a && neighbour != b && marks[neighbour->id] == mark )
+                {
+                    return false;
+                }
+            }
+        }
+
+        const bool boundary0 = is_boundary( v0 );
+        const bool boundary1 = is_boundary( v1 );
+
+        /// an inner edge between two border vertices would pinch the mesh
+        if( opposing && boundary0 && boundary1 )
+        {
+            return false;
+        }
+
+        /// an inner vertex across the edge with three faces would be left with two coincident ones
+        if( !is_boundary( a ) && face_count_around( a ) <= 3 )
+        {
+            return false;
+        }
+
+        if( b && !is_boundary( b ) && face_count_around( b ) <= 3 )
+        {
+            return false;
+        }
+
+        const auto & target = targets[edge->id];
+        const auto f1 = opposing ? opposing->face : nullptr;
+
+        return !flips( v0, v0, v1, target, edge->face, f1 ) && !flips( v1, v0, v1, target, edge->face, f1 );
+    };
+
+    /// link two outer halfedges of a removed face to each other, either may be missing
+    auto join = [&]( const EdgeHandle left, const EdgeHandle right )
+    {
+        if( left ) left->opposing = right;
+        if( right ) right->opposing = left;
+
+        const auto key = left ? key_of( left ) : right ? key_of( right ) : nullptr;
+
+        if( left ) heap.remove( left->id );
+        if( right ) heap.remove( right->id );
+        if( key ) evaluate( key );
+    };
+
+    size_t collapses = 0;
+
+    while( face_count > target_face_count && !heap.empty() )
+    {
+        const auto edge = &m_edges[heap.top()];
+        const auto v0 = edge->vertex;
+        const auto v1 = edge->next->vertex;
+
+        if( edge_stamps[edge->id] < std::max( vertex_stamps[v0->id], vertex_stamps[v1->id] ) )
+        {
+            evaluate( edge );
+            continue;
+        }
+
+        if( heap.top_cost() > max_error )
+        {
+            break;
+        }
+
+        heap.pop();
+
+        /// a rejected edge comes back when a collapse next to it changes its neighbourhood
+        if( !can_collapse( edge ) )
+        {
+            continue;
+        }
+
+        const auto target = targets[edge->id];
+
+        const auto edge_next = edge->next;
+        const auto edge_previous = edge_next->next;
+        const auto a = edge_previous->vertex;
+        const auto outer_next = edge_next->opposing;
+        const auto outer_previous = edge_previous->opposing;
+
+        const auto opposing = edge->opposing;
+        const auto opposing_next = opposing ? opposing->next : nullptr;
+        const auto opposing_previous = opposing ? opposing_next->next : nullptr;
+        const auto b = opposing ? opposing_previous->vertex : nullptr;
+        const auto opposing_outer_next = opposing ? opposing_next->opposing : nullptr;
+        const auto opposing_outer_previous = opposing ? opposing_previous->opposing : nullptr;
+
+        ring.clear();
+
+        for( const auto ring_edge : one_ring( v1 ) )
+        {
+            ring.push_back( ring_edge );
+        }
+
+        /// the vertices across the removed faces must not keep a removed halfedge
+        if( a->edge == edge_previous )
+        {
+            a->edge = outer_next ? outer_next : outer_previous->next;
+        }
+
+        if( b && b->edge == opposing_previous )
+        {
+            b->edge = opposing_outer_next ? opposing_outer_next : opposing_outer_previous->next;
+        }
+
+        /// v1 merges into v0
+        for( const auto ring_edge : ring )
+        {
+            ring_edge->vertex = v0;
+        }
+
+        if( v0->edge == edge || v0->edge == opposing_next )
+        {
+            v0->edge = outer_previous ? outer_previous : opposing_outer_previous;
+
+            for( size_t i = 0; v0->edge == nullptr && i < ring.size(); ++i )
+            {
+                if( ring[i] != edge_next && ring[i] != opposing )
+                {
+                    v0->edge = ring[i];
+                }
+            }
+        }
+
+        v0->position = target;
+        quadrics[v0->id] += quadrics[v1->id];
+
+        heap.remove( edge->id );
+        heap.remove( edge_next->id );
+        heap.remove( edge_previous->id );
+
+        if( opposing )
+        {
+            heap.remove( opposing->id );
+            heap.remove( opposing_next->id );
+            heap.remove( opposing_previous->id );
+        }
+
+        release_face( edge->face );
+        release_edge( edge_next );
+        release_edge( edge_previous );
+
+        if( opposing )
+        {
+            release_face( opposing->face );
+            release_edge( opposing_next );
+            release_edge( opposing_previous );
+            release_edge( opposing );
+            face_count -= 1;
+        }
+
+        release_edge( edge );
+        release_vertex( v1 );
+        face_count -= 1;
+
+        vertex_stamps[v0->id] = ++stamp;
+
+        join( outer_next, outer_previous );
+
+        if( opposing )
+        {
+            join( opposing_outer_next, opposing_outer_previous );
+        }
+
+        /// entries of the edges around v0 refresh lazily, edges rejected before get a new chance
+        for( const auto ring_edge : one_ring( v0 ) )
+        {
+            compute_normal( ring_edge->face );
+
+            for( const auto candidate : { ring_edge, ring_edge->next->next } )
+            {
+                const auto key = key_of( candidate );
+
+                if( !heap.contains( key->id ) )
+                {
+                    evaluate( key );
+                }
+            }
+        }
+
+        mark_dirty( v0 );
+        ++collapses;
+    }
+
+    if( collapses > 0 )
+    {
+        touch();
+        m_export_layout_valid = false;
+    }
+
+    return collapses;
+}
@@ -0,0 +1,524 @@
+#include "core/mesh/LinkedMesh.hpp"
+#include "core/mesh/MeshVersion.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined( _WIN32 )
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// read only view of a whole file, memory mapped where the platform allows it
+    class MappedFile
+    {
+    public:
+
+        explicit MappedFile( const std::string & path ) : m_data( nullptr ), m_size( 0 )
+        {
+#if defined( _WIN32 )
+            std::ifstream file( path, std::ios::binary );
+
+            if( file )
+            {
+                m_buffer.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+                m_data = m_buffer.data();
+                m_size = m_buffer.size();
+            }
+#else
+            const int descriptor = ::open( path.c_str(), O_RDONLY );
+
+            if( descriptor < 0 )
+            {
+                return;
+            }
+
+            struct stat status;
+
+            if( ::fstat( descriptor, &status ) == 0 && status.st_size > 0 )
+            {
+                void * mapping = ::mmap( nullptr, static_cast<size_t>( status.st_size ), PROT_READ, MAP_PRIVATE, descriptor, 0 );
+
+                if( mapping != MAP_FAILED )
+                {
+                    m_data = static_cast<const char*>( mapping );
+                    m_size = static_cast<size_t>( status.st_size );
+                }
+            }
+
+            ::close( descriptor );
+#endif
+        }
+
+        ~MappedFile()
+        {
+#if !defined( _WIN32 )
+            if( m_data != nullptr )
+            {
+                ::munmap( const_cast<char*>( m_data ), m_size );
+            }
+#endif
+        }
+
+        MappedFile( const MappedFile & ) = delete;
+        MappedFile & operator=( const MappedFile & ) = delete;
+
+        const char * data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+
+        const char * m_data;
+        size_t m_size;
+
+#if defined( _WIN32 )
+        std::vector<char> m_buffer;
+#endif
+    };
+
+    /// free list entries of a snapshot are in range, free and listed once
+    template<typename Record>
+    bool valid_free_list( const uint32_t * indices, const uint64_t size, const Record * records, const uint64_t count )
+    {
+        std::vector<uint8_t> listed( count, 0 );
+
+        for( uint64_t i = 0; i < size; ++i )
+        {
+            const auto index = indices[i];
+
+            if( index >= count || listed[index] || ( records[index].flags & mesh_snapshot::flag_initialized ) != 0 ) return false;
+
+            listed[index] = 1;
+        }
+
+        return true;
+    }
+
+    template<typename Handle>
+    inline uint32_t index_of( const Handle handle )
+    {
+        return handle != nullptr ? handle->id : mesh_snapshot::invalid_index;
+    }
+
+    /// write count records produced by store( i, record ) in blocks, then pad to 8 bytes
+    template<typename Record, typename Store>
+    void write_records( std::ofstream & file, const size_t count, Store store )
+    {
+        Record block[256];
+
+        for( size_t begin = 0; begin < count; begin += 256 )
+        {
+            const size_t size = std::min<size_t>( 256, count - begin );
+
+            for( size_t i = 0; i < size; ++i )
+            {
+                store( begin + i, block[i] );
+            }
+
+            file.write( reinterpret_cast<const char*>( block ), size * sizeof( Record ) );
+        }
+
+        const uint64_t bytes = count * sizeof( Record );
+        const char padding[8] = {};
+        file.write( padding, static_cast<std::streamsize>( mesh_snapshot::aligned_size( bytes ) - bytes ) );
+    }
+
+    /// Fill chunks with the records of count elements produced by store( i, record ), on up to thread_count
+    /// threads. A chunk equal to the one at the same place in previous is shared instead of copied
+    template<typename Chunk, typename Store>
+    void share_chunks( const size_t count, const std::vector<std::shared_ptr<const Chunk>> * previous,
+                       std::vector<std::shared_ptr<const Chunk>> & chunks, const unsigned int thread_count, Store store )
+    {
+        const size_t chunk_size = MeshVersion::chunk_size;
+        const auto chunk_count = ( count + chunk_size - 1 ) / chunk_size;
+        chunks.resize( chunk_count );
+
+        const auto threads = parallel_thread_count( chunk_count, thread_count, 64 );
+
+        parallel_for_blocks( chunk_count, threads, [&]( const unsigned int, const size_t begin, const size_t end )
+        {
+            Chunk chunk;
+
+            for( size_t c = begin; c < end; ++c )
+            {
+                /// unused records of the last chunk stay zero, so equal chunks compare equal bytewise
+                const auto first = c * chunk_size;
+                const auto size = std::min( chunk_size, count - first );
+                std::memset( &chunk, 0, sizeof( chunk ) );
+
+                for( size_t i = 0; i < size; ++i )
+                {
+                    store( first + i, chunk.records[i] );
+                }
+
+                if( previous != nullptr && c < previous->size() && std::memcmp( &chunk, ( *previous )[c].get(), sizeof( chunk ) ) == 0 )
+                {
+                    chunks[c] = ( *previous )[c];
+                }
+                else
+                {
+                    chunks[c] = std::make_shared<const Chunk>( chunk );
+                }
+            }
+        } );
+    }
+
+    /// write a free list, then pad to 8 bytes
+    void write_indices( std::ofstream & file, const std::vector<int> & indices )
+    {
+        for( const auto index : indices )
+        {
+            const uint32_t value = static_cast<uint32_t>( index );
+            file.write( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+        }
+
+        const uint64_t bytes = indices.size() * sizeof( uint32_t );
+        const char padding[8] = {};
+        file.write( padding, static_cast<std::streamsize>( mesh_snapshot::aligned_size( bytes ) - bytes ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::store( const Vertex & vertex, mesh_snapshot::VertexRecord & record ) const
+{
+    std::memcpy( record.position, &vertex.position[0], sizeof( record.position ) );
+    std::memcpy( record.color, &vertex.color[0], sizeof( record.color ) );
+    record.light = vertex.light;
+    record.edge = index_of( vertex.edge );
+    record.flags = vertex.initialized ? mesh_snapshot::flag_initialized : 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::store( const Edge & edge, mesh_snapshot::EdgeRecord & record ) const
+{
+    record.vertex = index_of( edge.vertex );
+    record.next = index_of( edge.next );
+    record.opposing = index_of( edge.opposing );
+    record.face = index_of( edge.face );
+    std::memcpy( record.texcoord, &edge.texcoord[0], sizeof( record.texcoord ) );
+    std::memcpy( record.barycenter, &edge.barycenter[0], sizeof( record.barycenter ) );
+    record.flags = edge.initialized ? mesh_snapshot::flag_initialized : 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::store( const Face & face, mesh_snapshot::FaceRecord & record ) const
+{
+    record.edge = index_of( face.edge );
+    std::memcpy( record.normal, &face.normal[0], sizeof( record.normal ) );
+    std::memcpy( record.color, &face.color[0], sizeof( record.color ) );
+    record.flags = face.initialized ? mesh_snapshot::flag_initialized : 0;
+    record.reserved = 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::restore( Vertex & vertex, const mesh_snapshot::VertexRecord & record )
+{
+    std::memcpy( &vertex.position[0], record.position, sizeof( record.position ) );
+    std::memcpy( &vertex.color[0], record.color, sizeof( record.color ) );
+    vertex.light = record.light;
+    vertex.edge = record.edge != mesh_snapshot::invalid_index ? &m_edges[record.edge] : nullptr;
+    vertex.initialized = ( record.flags & mesh_snapshot::flag_initialized ) != 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::restore( Edge & edge, const mesh_snapshot::EdgeRecord & record )
+{
+    edge.vertex = record.vertex != mesh_snapshot::invalid_index ? &m_vertices[record.vertex] : nullptr;
+    edge.next = record.next != mesh_snapshot::invalid_index ? &m_edges[record.next] : nullptr;
+    edge.opposing = record.opposing != mesh_snapshot::invalid_index ? &m_edges[record.opposing] : nullptr;
+    edge.face = record.face != mesh_snapshot::invalid_index ? &m_faces[record.face] : nullptr;
+    std::memcpy( &edge.texcoord[0], record.texcoord, sizeof( record.texcoord ) );
+    std::memcpy( &edge.barycenter[0], record.barycenter, sizeof( record.barycenter ) );
+    edge.initialized = ( record.flags & mesh_snapshot::flag_initialized ) != 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::restore( Face & face, const mesh_snapshot::FaceRecord & record )
+{
+    face.edge = record.edge != mesh_snapshot::invalid_index ? &m_edges[record.edge] : nullptr;
+    std::memcpy( &face.normal[0], record.normal, sizeof( record.normal ) );
+    std::memcpy( &face.color[0], record.color, sizeof( record.color ) );
+    face.initialized = ( record.flags & mesh_snapshot::flag_initialized ) != 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool LinkedMesh::save_snapshot( const std::string & path ) const
+{
+    std::ofstream file( path, std::ios::binary | std::ios::trunc );
+
+    if( !file )
+    {
+        return false;
+    }
+
+    mesh_snapshot::Header header;
+    std::memset( &header, 0, sizeof( header ) );
+    header.magic = mesh_snapshot::magic;
+    header.version = mesh_snapshot::version;
+    header.vertex_record_size = sizeof( mesh_snapshot::VertexRecord );
+    header.edge_record_size = sizeof( mesh_snapshot::EdgeRecord );
+    header.face_record_size = sizeof( mesh_snapshot::FaceRecord );
+    header.vertex_count = m_vertices.size();
+    header.edge_count = m_edges.size();
+    header.face_count = m_faces.size();
+    header.free_vertex_count = m_free_vertices.size();
+    header.free_edge_count = m_free_edges.size();
+    header.free_face_count = m_free_faces.size();
+
+    file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+    write_records<mesh_snapshot::VertexRecord>( file, m_vertices.size(), [this]( const size_t i, mesh_snapshot::VertexRecord & record )
+    {
+        store( m_vertices[i], record );
+    } );
+
+    write_records<mesh_snapshot::EdgeRecord>( file, m_edges.size(), [this]( const size_t i, mesh_snapshot::EdgeRecord & record )
+    {
+        store( m_edges[i], record );
+    } );
+
+    write_records<mesh_snapshot::FaceRecord>( file, m_faces.size(), [this]( const size_t i, mesh_snapshot::FaceRecord & record )
+    {
+        store( m_faces[i], record );
+    } );
+
+    write_indices( file, m_free_vertices );
+    write_indices( file, m_free_edges );
+    write_indices( file, m_free_faces );
+
+    return static_cast<bool>( file );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool LinkedMesh::load_snapshot( const std::string & path )
+{
+    const MappedFile file( path );
+
+    if( file.data() == nullptr || file.size() < sizeof( mesh_snapshot::Header ) )
+    {
+        return false;
+    }
+
+    mesh_snapshot::Header header;
+    std::memcpy( &header, file.data(), sizeof( header ) );
+
+    if( header.magic != mesh_snapshot::magic || header.version != mesh_snapshot::version ||
+        header.vertex_record_size != sizeof( mesh_snapshot::VertexRecord ) ||
+        header.edge_record_size != sizeof( mesh_snapshot::EdgeRecord ) ||
+        header.face_record_size != sizeof( mesh_snapshot::FaceRecord ) )
+    {
+        return false;
+    }
+
+    /// locate the arrays inside the mapping. Counts come from the file, so each one is checked against
+    /// the bytes left before it is multiplied by the record size
+    uint64_t offset = mesh_snapshot::aligned_size( sizeof( header ) );
+
+    auto locate = [&]( const uint64_t count, const uint64_t record_size, const char * & data )
+    {
+        if( offset > file.size() || count > ( file.size() - offset ) / record_size || count >= mesh_snapshot::invalid_index )
+        {
+            return false;
+        }
+
+        data = file.data() + offset;
+        offset += mesh_snapshot::aligned_size( count * record_size );
+        return true;
+    };
+
+    const char * vertex_data = nullptr;
+    const char * edge_data = nullptr;
+    const char * face_data = nullptr;
+    const char * free_vertex_data = nullptr;
+    const char * free_edge_data = nullptr;
+    const char * free_face_data = nullptr;
+
+    if( !locate( header.vertex_count, sizeof( mesh_snapshot::VertexRecord ), vertex_data ) ||
+        !locate( header.edge_count, sizeof( mesh_snapshot::EdgeRecord ), edge_data ) ||
+        !locate( header.face_count, sizeof( mesh_snapshot::FaceRecord ), face_data ) ||
+        !locate( header.free_vertex_count, sizeof( uint32_t ), free_vertex_data ) ||
+        !locate( header.free_edge_count, sizeof( uint32_t ), free_edge_data ) ||
+        !locate( header.free_face_count, sizeof( uint32_t ), free_face_data ) ||
+        offset > file.size() )
+    {
+        return false;
+    }
+
+    const auto vertices = reinterpret_cast<const mesh_snapshot::VertexRecord*>( vertex_data );
+    const auto edges = reinterpret_cast<const mesh_snapshot::EdgeRecord*>( edge_data );
+    const auto faces = reinterpret_cast<const mesh_snapshot::FaceRecord*>( face_data );
+    const auto free_vertices = reinterpret_cast<const uint32_t*>( free_vertex_data );
+    const auto free_edges = reinterpret_cast<const uint32_t*>( free_edge_data );
+    const auto free_faces = reinterpret_cast<const uint32_t*>( free_face_data );
+
+    /// Validate the links before touching the mesh, a corrupt file must not leave loops that never
+    /// close or links to free elements behind. Live elements link only to live elements, free elements
+    /// link to nothing
+    auto live = []( const uint32_t flags )
+    {
+        return ( flags & mesh_snapshot::flag_initialized ) != 0;
+    };
+
+    auto links_to = [&]( const uint32_t index, const uint64_t count, const bool referenced_is_live )
+    {
+        return index == mesh_snapshot::invalid_index || ( index < count && referenced_is_live );
+    };
+
+    for( uint64_t i = 0; i < header.vertex_count; ++i )
+    {
+        const auto & vertex = vertices[i];
+        const auto edge_live = vertex.edge < header.edge_count && live( edges[vertex.edge].flags );
+
+        if( live( vertex.flags ) ? !links_to( vertex.edge, header.edge_count, edge_live ) : vertex.edge != mesh_snapshot::invalid_index ) return false;
+    }
+
+    for( uint64_t i = 0; i < header.edge_count; ++i )
+    {
+        const auto & edge = edges[i];
+
+        if( !live( edge.flags ) )
+        {
+            if( edge.vertex != mesh_snapshot::invalid_index || edge.next != mesh_snapshot::invalid_index ||
+                edge.opposing != mesh_snapshot::invalid_index || edge.face != mesh_snapshot::invalid_index ) return false;
+
+            continue;
+        }
+
+        const auto vertex_live = edge.vertex < header.vertex_count && live( vertices[edge.vertex].flags );
+        const auto next_live = edge.next < header.edge_count && live( edges[edge.next].flags );
+        const auto opposing_live = edge.opposing < header.edge_count && live( edges[edge.opposing].flags );
+        const auto face_live = edge.face < header.face_count && live( faces[edge.face].flags );
+
+        if( !links_to( edge.vertex, header.vertex_count, vertex_live ) || !links_to( edge.next, header.edge_count, next_live ) ||
+            !links_to( edge.opposing, header.edge_count, opposing_live ) || !links_to( edge.face, header.face_count, face_live ) ) return false;
+
+        /// opposing links come in pairs, circulators rely on it
+        if( edge.opposing != mesh_snapshot::invalid_index && edges[edge.opposing].opposing != i ) return false;
+
+        /// an edge of a face is exported, it needs its vertex and the rest of the loop
+        if( edge.face != mesh_snapshot::invalid_index && ( edge.vertex == mesh_snapshot::invalid_index || edge.next == mesh_snapshot::invalid_index ) ) return false;
+    }
+
+    /// every face loop closes, visiting each edge once; a loop running into a visited edge cycles.
+    /// A face needs three edges, triangulating fewer would count a negative number of corners
+    std::vector<uint8_t> visited( header.edge_count, 0 );
+
+    for( uint64_t i = 0; i < header.face_count; ++i )
+    {
+        const auto & face = faces[i];
+
+        if( !live( face.flags ) )
+        {
+            if( face.edge != mesh_snapshot::invalid_index ) return false;
+
+            continue;
+        }
+
+        if( face.edge == mesh_snapshot::invalid_index || face.edge >= header.edge_count ) return false;
+
+        auto edge = face.edge;
+        uint64_t loop_length = 0;
+
+        do
+        {
+            if( visited[edge] || edges[edge].face != i ) return false;
+
+            visited[edge] = 1;
+            ++loop_length;
+            edge = edges[edge].next;
+        }
+        while( edge != face.edge );
+
+        if( loop_length < 3 ) return false;
+    }
+
+    /// an edge claiming a face must be on its loop
+    for( uint64_t i = 0; i < header.edge_count; ++i )
+    {
+        if( edges[i].face != mesh_snapshot::invalid_index && !visited[i] ) return false;
+    }
+
+    if( !valid_free_list( free_vertices, header.free_vertex_count, vertices, header.vertex_count ) ||
+        !valid_free_list( free_edges, header.free_edge_count, edges, header.edge_count ) ||
+        !valid_free_list( free_faces, header.free_face_count, faces, header.face_count ) )
+    {
+        return false;
+    }
+
+    clear();
+    reserve( header.vertex_count, header.edge_count, header.face_count );
+
+    /// allocate every element first so links can be resolved to their final address
+    for( uint64_t i = 0; i < header.vertex_count; ++i )
+    {
+        m_vertices.emplace_back( m_vertices.size(), vec3( 0.0f, 0.0f, 0.0f ) );
+    }
+
+    for( uint64_t i = 0; i < header.edge_count; ++i )
+    {
+        m_edges.emplace_back( m_edges.size(), nullptr );
+    }
+
+    for( uint64_t i = 0; i < header.face_count; ++i )
+    {
+        m_faces.emplace_back( m_faces.size(), nullptr );
+    }
+
+    for( uint64_t i = 0; i < header.vertex_count; ++i )
+    {
+        restore( m_vertices[i], vertices[i] );
+    }
+
+    for( uint64_t i = 0; i < header.edge_count; ++i )
+    {
+        restore( m_edges[i], edges[i] );
+    }
+
+    for( uint64_t i = 0; i < header.face_count; ++i )
+    {
+        restore( m_faces[i], faces[i] );
+    }
+
+    m_free_vertices.assign( free_vertices, free_vertices + header.free_vertex_count );
+    m_free_edges.assign( free_edges, free_edges + header.free_edge_count );
+    m_free_faces.assign( free_faces, free_faces + header.free_face_count );
+
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const MeshVersion> LinkedMesh::make_version( const MeshVersion * previous, const unsigned int thread_count ) const
+{
+    std::shared_ptr<MeshVersion> version( new MeshVersion() );
+    version->m_revision = m_revision;
+    version->m_vertex_count = m_vertices.size();
+    version->m_edge_count = m_edges.size();
+    version->m_face_count = m_faces.size();
+
+    share_chunks( m_vertices.size(), previous ? &previous->m_vertex_chunks : nullptr, version->m_vertex_chunks, thread_count,
+                  [this]( const size_t i, mesh_snapshot::VertexRecord & record )
+    {
+        store( m_vertices[i], record );
+    } );
+
+    share_chunks( m_edges.size(), previous ? &previous->m_edge_chunks : nullptr, version->m_edge_chunks, thread_count,
+                  [this]( const size_t i, mesh_snapshot::EdgeRecord & record )
+    {
+        store( m_edges[i], record );
+    } );
+
+    share_chunks( m_faces.size(), previous ? &previous->m_face_chunks : nullptr, version->m_face_chunks, thread_count,
+                  [this]( const size_t i, mesh_snapshot::FaceRecord & record )
+    {
+        store( m_faces[i], record );
+    } );
+
+    return version;
+}
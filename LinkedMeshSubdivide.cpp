@@ -0,0 +1,415 @@
+#include "core/mesh/LinkedMesh.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    /// the neighbours of vertex along the open border, false when vertex is inside the mesh
+    bool border_neighbours( const VertexHandle vertex, VertexHandle & before, VertexHandle & after )
+    {
+        before = nullptr;
+        after = nullptr;
+
+        for( const auto edge : VertexOneRing( vertex ) )
+        {
+            if( edge->opposing == nullptr )
+            {
+                after = edge->next->vertex;
+            }
+
+            const auto previous = previous_edge( edge );
+
+            if( previous->opposing == nullptr )
+            {
+                before = previous->vertex;
+            }
+        }
+
+        return before != nullptr && after != nullptr;
+    }
+
+    /// call function( i ) for i in [0, count), split over up to thread_count threads
+    template<typename Function>
+    void parallel_for_each( const size_t count, const unsigned int thread_count, const size_t min_items_per_thread, Function function )
+    {
+        const auto threads = parallel_thread_count( count, thread_count, min_items_per_thread );
+
+        parallel_for_blocks( count, threads, [&]( const unsigned int, const size_t begin, const size_t end )
+        {
+            for( size_t i = begin; i < end; ++i )
+            {
+                function( i );
+            }
+        } );
+    }
+
+    /// halfedges leaving vertex
+    size_t valence( const VertexHandle vertex )
+    {
+        size_t count = 0;
+
+        for( const auto edge : VertexOneRing( vertex ) )
+        {
+            ( void )edge;
+            ++count;
+        }
+
+        return count;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool LinkedMesh::subdivide( const Subdivision scheme, const unsigned int levels, const unsigned int thread_count )
+{
+    for( const auto & edge : m_edges )
+    {
+        if( edge.initialized && edge.face == nullptr )
+        {
+            return false;
+        }
+    }
+
+    if( scheme == Subdivision::Loop )
+    {
+        for( const auto & face : m_faces )
+        {
+            if( face.initialized && edge_count( face ) != 3 )
+            {
+                return false;
+            }
+        }
+    }
+
+    for( unsigned int level = 0; level < levels; ++level )
+    {
+        subdivide_level( scheme, thread_count );
+    }
+
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void LinkedMesh::subdivide_level( const Subdivision scheme, const unsigned int thread_count )
+{
+    /// dense ids, so every element can be addressed by id in the refined level
+    CompactionMap map;
+    compact( map );
+
+    const auto vertex_count = m_vertices.size();
+    const auto halfedge_count = m_edges.size();
+    const auto face_count = m_faces.size();
+
+    /// one edge point per undirected edge, stored under the halfedge with the lower id
+    std::vector<uint32_t> edge_point( halfedge_count );
+    std::vector<EdgeHandle> edge_keys;
+    edge_keys.reserve( halfedge_count );
+
+    for( auto & edge : m_edges )
+    {
+        if( edge.opposing == nullptr || edge.id < edge.opposing->id )
+        {
+            edge_point[edge.id] = static_cast<uint32_t>( edge_keys.size() );
+            edge_keys.push_back( &edge );
+        }
+    }
+
+    for( const auto & edge : m_edges )
+    {
+        if( edge.opposing != nullptr && edge.opposing->id < edge.id )
+        {
+            edge_point[edge.id] = edge_point[edge.opposing->id];
+        }
+    }
+
+    const auto catmull_clark = scheme == Subdivision::CatmullClark;
+    const auto undirected_count = edge_keys.size();
+
+    /// Catmull-Clark: every corner becomes a quad, new vertices at edges and faces.
+    /// Loop: every corner becomes a triangle and every face a center triangle, new vertices at edges
+    const auto corner_edges = catmull_clark ? size_t( 4 ) : size_t( 3 );
+    const auto new_vertex_count = vertex_count + undirected_count + ( catmull_clark ? face_count : 0 );
+    const auto new_edge_count = halfedge_count * corner_edges + ( catmull_clark ? 0 : face_count * 3 );
+    const auto new_face_count = halfedge_count + ( catmull_clark ? 0 : face_count );
+
+    SlabPool<Vertex> refined_vertices;
+    SlabPool<Edge> refined_edges;
+    SlabPool<Face> refined_faces;
+    refined_vertices.reserve( new_vertex_count );
+    refined_edges.reserve( new_edge_count );
+    refined_faces.reserve( new_face_count );
+
+    for( size_t i = 0; i < new_vertex_count; ++i )
+    {
+        refined_vertices.emplace_back( static_cast<uint>( i ), vec3() ).initialized = true;
+    }
+
+    for( size_t i = 0; i < new_edge_count; ++i )
+    {
+        refined_edges.emplace_back( static_cast<uint>( i ), nullptr ).initialized = true;
+    }
+
+    for( size_t i = 0; i < new_face_count; ++i )
+    {
+        refined_faces.emplace_back( static_cast<uint>( i ), nullptr ).initialized = true;
+    }
+
+    const auto edge_base = vertex_count;
+    const auto face_base = vertex_count + undirected_count;
+
+    /// face points, the centroid of every face
+    if( catmull_clark )
+    {
+        parallel_for_each( face_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+        {
+            auto & point = refined_vertices[face_base + i];
+            size_t corners = 0;
+            vec3 position( 0.0f );
+            vec4 color( 0.0f );
+            float light = 0.0f;
+
+            for( const auto edge : edges( &m_faces[i] ) )
+            {
+                position += edge->vertex->position;
+                color += edge->vertex->color;
+                light += edge->vertex->light;
+                ++corners;
+            }
+
+            const auto weight = 1.0f / corners;
+            point.position = position * weight;
+            point.color = color * weight;
+            point.light = light * weight;
+        } );
+    }
+
+    /// edge points
+    parallel_for_each( undirected_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+    {
+        const auto edge = edge_keys[i];
+        const auto v0 = edge->vertex;
+        const auto v1 = edge->next->vertex;
+        auto & point = refined_vertices[edge_base + i];
+
+        point.color = ( v0->color + v1->color ) * 0.5f;
+        point.light = ( v0->light + v1->light ) * 0.5f;
+
+        if( edge->opposing == nullptr )
+        {
+            /// border edges stay a curve of their own
+            point.position = ( v0->position + v1->position ) * 0.5f;
+        }
+        else if( catmull_clark )
+        {
+            const auto & f0 = refined_vertices[face_base + edge->face->id].position;
+            const auto & f1 = refined_vertices[face_base + edge->opposing->face->id].position;
+
+            point.position = ( v0->position + v1->position + f0 + f1 ) * 0.25f;
+        }
+        else
+        {
+            const auto & a = edge->next->next->vertex->position;
+            const auto & b = edge->opposing->next->next->vertex->position;
+
+            point.position = ( v0->position + v1->position ) * 0.375f + ( a + b ) * 0.125f;
+        }
+    } );
+
+    /// original vertices move towards the limit surface
+    parallel_for_each( vertex_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+    {
+        const auto vertex = &m_vertices[i];
+        auto & point = refined_vertices[i];
+
+        point.color = vertex->color;
+        point.light = vertex->light;
+        point.position = vertex->position;
+
+        if( vertex->edge == nullptr )
+        {
+            return;
+        }
+
+        VertexHandle before, after;
+
+        if( border_neighbours( vertex, before, after ) )
+        {
+            point.position = vertex->position * 0.75f + ( before->position + after->position ) * 0.125f;
+            return;
+        }
+
+        const auto n = static_cast<float>( valence( vertex ) );
+
+        if( catmull_clark )
+        {
+            /// ( Q + 2R + ( n - 3 ) S ) / n, Q the mean face point and R the mean edge midpoint
+            vec3 faces_sum( 0.0f ), midpoints_sum( 0.0f );
+
+            for( const auto edge : one_ring( vertex ) )
+            {
+                faces_sum += refined_vertices[face_base + edge->face->id].position;
+                midpoints_sum += ( vertex->position + edge->next->vertex->position ) * 0.5f;
+            }
+
+            point.position = ( faces_sum / n + midpoints_sum * ( 2.0f / n ) + vertex->position * ( n - 3.0f ) ) / n;
+        }
+        else
+        {
+            /// Warren's weights
+            const auto beta = n > 3.0f ? 3.0f / ( 8.0f * n ) : 3.0f / 16.0f;
+            vec3 neighbours_sum( 0.0f );
+
+            for( const auto edge : one_ring( vertex ) )
+            {
+                neighbours_sum += edge->next->vertex->position;
+            }
+
+            point.position = vertex->position * ( 1.0f - n * beta ) + neighbours_sum * beta;
+        }
+    } );
+
+    /// Topology, written face by face. The refined elements of a corner are numbered from the id of the
+    /// halfedge leaving that corner, so opposing elements are found by index without any lookup.
+    /// Catmull-Clark quad of corner h, with p the halfedge before h:
+    ///   4h + 0: h->vertex to mid( h ), 4h + 1: mid( h ) to center, 4h + 2: center to mid( p ), 4h + 3: mid( p ) to h->vertex
+    /// Loop corner triangle of h: 3h + 0: h->vertex to mid( h ), 3h + 1: mid( h ) to mid( p ), 3h + 2: mid( p ) to h->vertex
+    /// Loop center triangle of face f, after all corners: 3H + 3f + i: mid( h_i ) to mid( h_i+1 )
+    auto new_edge = [&]( const size_t index ) -> EdgeHandle
+    {
+        return &refined_edges[index];
+    };
+
+    auto opposing_of = [&]( const EdgeHandle edge, const size_t offset ) -> EdgeHandle
+    {
+        return edge ? new_edge( edge->id * corner_edges + offset ) : nullptr;
+    };
+
+    parallel_for_each( face_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+    {
+        const auto face = &m_faces[i];
+        const auto first = face->edge;
+
+        vec2 center_texcoord( 0.0f );
+        size_t corners = 0;
+
+        for( const auto edge : edges( face ) )
+        {
+            center_texcoord = center_texcoord + edge->texcoord;
+            ++corners;
+        }
+
+        center_texcoord = center_texcoord * ( 1.0f / corners );
+
+        auto previous = previous_edge( first );
+        size_t corner = 0;
+
+        for( auto edge = first; ; previous = edge, edge = edge->next, ++corner )
+        {
+            const auto id = edge->id;
+            const auto base = id * corner_edges;
+            auto & child = refined_faces[id];
+
+            child.edge = new_edge( base );
+            child.color = face->color;
+
+            const auto mid = &refined_vertices[edge_base + edge_point[id]];
+            const auto mid_previous = &refined_vertices[edge_base + edge_point[previous->id]];
+            const auto mid_texcoord = ( edge->texcoord + edge->next->texcoord ) * 0.5f;
+            const auto mid_previous_texcoord = ( previous->texcoord + edge->texcoord ) * 0.5f;
+
+            const auto opposing_next = edge->opposing ? edge->opposing->next : nullptr;
+
+            if( catmull_clark )
+            {
+                const VertexHandle corner_vertices[4] = { &refined_vertices[edge->vertex->id], mid, &refined_vertices[face_base + i], mid_previous };
+                const vec2 corner_texcoords[4] = { edge->texcoord, mid_texcoord, center_texcoord, mid_previous_texcoord };
+                const EdgeHandle opposing[4] =
+                {
+                    opposing_of( opposing_next, 3 ),
+                    opposing_of( edge->next, 2 ),
+                    opposing_of( previous, 1 ),
+                    opposing_of( previous->opposing, 0 )
+                };
+
+                for( size_t k = 0; k < 4; ++k )
+                {
+                    auto & half = refined_edges[base + k];
+                    half.vertex = corner_vertices[k];
+                    half.next = new_edge( base + ( k + 1 ) % 4 );
+                    half.opposing = opposing[k];
+                    half.face = &child;
+                    half.texcoord = corner_texcoords[k];
+                }
+            }
+            else
+            {
+                const VertexHandle corner_vertices[3] = { &refined_vertices[edge->vertex->id], mid, mid_previous };
+                const vec2 corner_texcoords[3] = { edge->texcoord, mid_texcoord, mid_previous_texcoord };
+                const auto center_edge = halfedge_count * 3 + i * 3;
+                const EdgeHandle opposing[3] =
+                {
+                    opposing_of( opposing_next, 2 ),
+                    new_edge( center_edge + ( corner + 2 ) % 3 ),
+                    opposing_of( previous->opposing, 0 )
+                };
+
+                for( size_t k = 0; k < 3; ++k )
+                {
+                    auto & half = refined_edges[base + k];
+                    half.vertex = corner_vertices[k];
+                    half.next = new_edge( base + ( k + 1 ) % 3 );
+                    half.opposing = opposing[k];
+                    half.face = &child;
+                    half.texcoord = corner_texcoords[k];
+                }
+
+                /// center halfedge from mid( edge ) to mid( edge->next ), across from the corner triangle of edge->next
+                auto & center = refined_edges[center_edge + corner];
+                center.vertex = mid;
+                center.next = new_edge( center_edge + ( corner + 1 ) % 3 );
+                center.opposing = new_edge( edge->next->id * 3 + 1 );
+                center.face = &refined_faces[halfedge_count + i];
+                center.texcoord = mid_texcoord;
+            }
+
+            if( edge->next == first )
+            {
+                break;
+            }
+        }
+
+        if( !catmull_clark )
+        {
+            auto & center = refined_faces[halfedge_count + i];
+            center.edge = new_edge( halfedge_count * 3 + i * 3 );
+            center.color = face->color;
+        }
+    } );
+
+    /// a halfedge leaving every new vertex
+    parallel_for_each( vertex_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+    {
+        const auto edge = m_vertices[i].edge;
+        refined_vertices[i].edge = edge ? new_edge( edge->id * corner_edges ) : nullptr;
+    } );
+
+    parallel_for_each( undirected_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+    {
+        refined_vertices[edge_base + i].edge = new_edge( edge_keys[i]->id * corner_edges + 1 );
+    } );
+
+    if( catmull_clark )
+    {
+        parallel_for_each( face_count, thread_count, parallel_faces_per_thread, [&]( const size_t i )
+        {
+            refined_vertices[face_base + i].edge = new_edge( m_faces[i].edge->id * 4 + 2 );
+        } );
+    }
+
+    m_vertices.swap( refined_vertices );
+    m_edges.swap( refined_edges );
+    m_faces.swap( refined_faces );
+
+    touch();
+    m_export_layout_valid = false;
+    compute_normals();
+}
@@ -0,0 +1,1270 @@
+#include "core/mesh/MeshImporter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    /// smallest share of a text chunk worth a thread of its own
+    const size_t parallel_bytes_per_thread = 1 << 20;
+
+    /// smallest share of binary vertices worth a thread of its own
+    const size_t parallel_vertices_per_thread = 16384;
+
+    inline bool is_blank( const char c )
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    inline bool is_line_end( const char c )
+    {
+        return c == '\n' || c == '\r';
+    }
+
+    inline void skip_blanks( const char *& p )
+    {
+        while( is_blank( *p ) )
+        {
+            ++p;
+        }
+    }
+
+    /// move p past the next line break, lines are always terminated inside a parsed range
+    inline void next_line( const char *& p, const char * end )
+    {
+        while( p < end && *p != '\n' )
+        {
+            ++p;
+        }
+
+        if( p < end )
+        {
+            ++p;
+        }
+    }
+
+    /// parse a number on the current line, false at the end of the line or on garbage
+    inline bool parse_number( const char *& p, double & value )
+    {
+        skip_blanks( p );
+
+        if( is_line_end( *p ) )
+        {
+            return false;
+        }
+
+        char * end;
+        value = std::strtod( p, &end );
+
+        if( end == p )
+        {
+            return false;
+        }
+
+        p = end;
+        return true;
+    }
+
+    inline bool parse_integer( const char *& p, int64_t & value )
+    {
+        const bool negative = *p == '-';
+
+        if( negative || *p == '+' )
+        {
+            ++p;
+        }
+
+        if( *p < '0' || *p > '9' )
+        {
+            return false;
+        }
+
+        value = 0;
+
+        /// 18 digits always fit in int64_t, longer numbers are rejected instead of overflowing
+        for( int digits = 0; *p >= '0' && *p <= '9'; ++digits )
+        {
+            if( digits == 18 )
+            {
+                return false;
+            }
+
+            value = value * 10 + ( *p++ - '0' );
+        }
+
+        if( negative )
+        {
+            value = -value;
+        }
+
+        return true;
+    }
+
+    /// bytes from the read position to the end of the file when the stream can seek, unlimited otherwise
+    inline size_t bytes_left( std::istream & file )
+    {
+        size_t left = std::numeric_limits<size_t>::max();
+        const auto position = file.tellg();
+
+        if( position != std::streampos( -1 ) && file.seekg( 0, std::ios::end ) )
+        {
+            left = static_cast<size_t>( file.tellg() - position );
+            file.seekg( position );
+        }
+
+        file.clear();
+        return left;
+    }
+
+    /// buffered binary input handing out contiguous runs of bytes
+    class BinaryReader
+    {
+    public:
+
+        BinaryReader( std::istream & file, const size_t chunk_size ) :
+            m_file( file ), m_chunk_size( chunk_size ), m_begin( 0 ), m_end( 0 ), m_file_left( bytes_left( file ) )
+        {
+        }
+
+        /// bytes that can still be taken, buffered or in the file
+        size_t remaining() const
+        {
+            const auto buffered = m_end - m_begin;
+            return m_file_left > std::numeric_limits<size_t>::max() - buffered ? std::numeric_limits<size_t>::max() : buffered + m_file_left;
+        }
+
+        /// the next size bytes of the file, nullptr if the file ends before
+        const char * take( const size_t size )
+        {
+            if( m_end - m_begin < size )
+            {
+                if( m_end > m_begin )
+                {
+                    std::memmove( m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin );
+                }
+
+                m_end -= m_begin;
+                m_begin = 0;
+
+                m_buffer.resize( std::max( m_chunk_size, size ) );
+                m_file.read( m_buffer.data() + m_end, m_buffer.size() - m_end );
+                m_end += static_cast<size_t>( m_file.gcount() );
+                m_file_left -= std::min( m_file_left, static_cast<size_t>( m_file.gcount() ) );
+
+                if( m_end < size )
+                {
+                    return nullptr;
+                }
+            }
+
+            const char * data = m_buffer.data() + m_begin;
+            m_begin += size;
+            return data;
+        }
+
+    private:
+
+        std::istream & m_file;
+        size_t m_chunk_size;
+        std::vector<char> m_buffer;
+        size_t m_begin;
+        size_t m_end;
+        size_t m_file_left;
+    };
+
+    /// Length of a list read as a double, rejected when it is negative, fractional or more than limit.
+    /// The comparison happens before the conversion, which is undefined for values out of range
+    inline bool list_length( const double value, const size_t limit, size_t & length )
+    {
+        const auto representable = std::min<size_t>( limit, size_t( 1 ) << 52 );
+
+        if( !( value >= 0.0 ) || value > double( representable ) || value != std::floor( value ) )
+        {
+            return false;
+        }
+
+        length = static_cast<size_t>( value );
+        return true;
+    }
+
+    /// Vertex index read as a double, rejected when it is not a number or outside of int64_t.
+    /// Like list_length the comparison comes first, the conversion of such a value is undefined
+    inline bool vertex_index( const double value, int64_t & index )
+    {
+        /// 2^63, exactly representable as a double
+        const double limit = 9223372036854775808.0;
+
+        if( !( value >= -limit && value < limit ) )
+        {
+            return false;
+        }
+
+        index = static_cast<int64_t>( value );
+        return true;
+    }
+
+    inline bool host_is_big_endian()
+    {
+        const uint16_t value = 1;
+        uint8_t first;
+        std::memcpy( &first, &value, 1 );
+        return first == 0;
+    }
+
+    template<typename T>
+    inline double load( const char * data, const bool swap_bytes )
+    {
+        char bytes[sizeof( T )];
+        std::memcpy( bytes, data, sizeof( T ) );
+
+        if( swap_bytes )
+        {
+            std::reverse( bytes, bytes + sizeof( T ) );
+        }
+
+        T value;
+        std::memcpy( &value, bytes, sizeof( T ) );
+        return static_cast<double>( value );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshImporter::ParsedBlock::clear()
+{
+    positions.clear();
+    colors.clear();
+    texcoords.clear();
+    corners.clear();
+    corner_texcoords.clear();
+    face_sizes.clear();
+    face_vertex_counts.clear();
+    face_texcoord_counts.clear();
+    values.clear();
+    line_ends.clear();
+    valid = true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshImporter::MeshImporter( LinkedMesh & mesh, const size_t chunk_size, const unsigned int thread_count ) :
+    m_mesh( mesh ),
+    m_builder( mesh, 0.0f ),
+    m_chunk_size( std::max<size_t>( chunk_size, 4096 ) ),
+    m_thread_count( thread_count ),
+    m_vertex_texcoords( false ),
+    m_face_count( 0 ),
+    m_open_edge_count( 0 ),
+    m_open_edge_base( 0 )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshImporter::~MeshImporter()
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::import( const std::string & path )
+{
+    const auto dot = path.find_last_of( '.' );
+
+    if( dot == std::string::npos )
+    {
+        return false;
+    }
+
+    std::string extension = path.substr( dot + 1 );
+    std::transform( extension.begin(), extension.end(), extension.begin(), []( const char c ){ return static_cast<char>( std::tolower( c ) ); } );
+
+    if( extension == "obj" )
+    {
+        return import_obj( path );
+    }
+
+    if( extension == "ply" )
+    {
+        return import_ply( path );
+    }
+
+    return false;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshImporter::begin_import( const size_t vertex_count, const size_t face_count )
+{
+    m_vertices.clear();
+    m_texcoords.clear();
+    m_vertex_texcoords = false;
+    m_face_count = 0;
+    m_open_edge_count = 0;
+    m_open_edge_base = m_builder.open_edge_count();
+
+    if( vertex_count > 0 || face_count > 0 )
+    {
+        /// a triangle dominant scan into an empty mesh, the slabs grow on their own otherwise
+        m_mesh.reserve( vertex_count, face_count * 3, face_count );
+        m_vertices.reserve( vertex_count );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshImporter::end_import()
+{
+    m_open_edge_count = m_builder.open_edge_count() - m_open_edge_base;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshImporter::FaceHandle MeshImporter::add_face( const int64_t * indices, const size_t count )
+{
+    m_corners.clear();
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        if( indices[i] < 0 || static_cast<size_t>( indices[i] ) >= m_vertices.size() )
+        {
+            return nullptr;
+        }
+
+        m_corners.push_back( m_vertices[indices[i]] );
+    }
+
+    const auto face = m_builder.add_face( m_corners.data(), m_corners.size() );
+
+    if( m_vertex_texcoords )
+    {
+        size_t corner = 0;
+
+        for( auto edge : m_mesh.edges( face ) )
+        {
+            edge->texcoord = m_texcoords[indices[corner++]];
+        }
+    }
+
+    ++m_face_count;
+    return face;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Parse, typename Insert>
+bool MeshImporter::read_lines( std::istream & file, Parse parse, Insert insert )
+{
+    std::vector<char> buffer;
+    std::vector<size_t> boundaries;
+    size_t carry = 0;
+
+    while( true )
+    {
+        /// one spare byte to terminate the last line of the file
+        buffer.resize( carry + m_chunk_size + 1 );
+        file.read( buffer.data() + carry, m_chunk_size );
+
+        const size_t size = carry + static_cast<size_t>( file.gcount() );
+        const bool end_of_file = !file;
+
+        if( size == 0 )
+        {
+            return true;
+        }
+
+        size_t end = size;
+
+        if( end_of_file )
+        {
+            buffer[end++] = '\n';
+        }
+        else
+        {
+            while( end > 0 && buffer[end - 1] != '\n' )
+            {
+                --end;
+            }
+
+            if( end == 0 )
+            {
+                /// a line longer than the chunk, keep reading
+                carry = size;
+                continue;
+            }
+        }
+
+        /// split the chunk into one run of whole lines per thread
+        const unsigned int thread_count = parallel_thread_count( end, m_thread_count, parallel_bytes_per_thread );
+        const char * data = buffer.data();
+
+        boundaries.assign( 1, 0 );
+
+        for( unsigned int block = 1; block < thread_count; ++block )
+        {
+            const char * p = data + std::max( boundaries.back(), end * block / thread_count );
+            next_line( p, data + end );
+            boundaries.push_back( p - data );
+        }
+
+        boundaries.push_back( end );
+
+        if( m_blocks.size() < thread_count )
+        {
+            m_blocks.resize( thread_count );
+        }
+
+        parallel_for_blocks( thread_count, thread_count, [&]( const unsigned int block, const size_t, const size_t )
+        {
+            m_blocks[block].clear();
+            parse( data + boundaries[block], data + boundaries[block + 1], m_blocks[block] );
+        } );
+
+        for( unsigned int block = 0; block < thread_count; ++block )
+        {
+            if( !m_blocks[block].valid || !insert( m_blocks[block] ) )
+            {
+                return false;
+            }
+        }
+
+        if( end_of_file )
+        {
+            return true;
+        }
+
+        carry = size - end;
+        std::memmove( buffer.data(), buffer.data() + end, carry );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshImporter::parse_obj_lines( const char * begin, const char * end, ParsedBlock & block )
+{
+    for( const char * p = begin; p < end; next_line( p, end ) )
+    {
+        skip_blanks( p );
+
+        if( p[0] == 'v' && is_blank( p[1] ) )
+        {
+            p += 1;
+
+            double x, y, z, r, g, b;
+
+            if( !parse_number( p, x ) || !parse_number( p, y ) || !parse_number( p, z ) )
+            {
+                block.valid = false;
+                return;
+            }
+
+            block.positions.push_back( vec3( x, y, z ) );
+
+            /// some writers append a vertex color
+            if( parse_number( p, r ) && parse_number( p, g ) && parse_number( p, b ) )
+            {
+                block.colors.push_back( vec4( r, g, b, 1.0f ) );
+            }
+            else
+            {
+                block.colors.push_back( vec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+            }
+        }
+        else if( p[0] == 'v' && p[1] == 't' && is_blank( p[2] ) )
+        {
+            p += 2;
+
+            double u, v = 0.0;
+
+            if( !parse_number( p, u ) )
+            {
+                block.valid = false;
+                return;
+            }
+
+            parse_number( p, v );
+            block.texcoords.push_back( vec2( u, v ) );
+        }
+        else if( p[0] == 'f' && is_blank( p[1] ) )
+        {
+            p += 1;
+
+            block.face_vertex_counts.push_back( static_cast<uint32_t>( block.positions.size() ) );
+            block.face_texcoord_counts.push_back( static_cast<uint32_t>( block.texcoords.size() ) );
+
+            uint32_t count = 0;
+
+            while( true )
+            {
+                skip_blanks( p );
+
+                if( is_line_end( *p ) )
+                {
+                    break;
+                }
+
+                /// v, v/vt, v//vn or v/vt/vn
+                int64_t vertex, texcoord = 0, normal;
+
+                if( !parse_integer( p, vertex ) )
+                {
+                    block.valid = false;
+                    return;
+                }
+
+                if( *p == '/' )
+                {
+                    ++p;
+
+                    if( *p != '/' )
+                    {
+                        parse_integer( p, texcoord );
+                    }
+
+                    if( *p == '/' )
+                    {
+                        ++p;
+                        parse_integer( p, normal );
+                    }
+                }
+
+                block.corners.push_back( vertex );
+                block.corner_texcoords.push_back( texcoord );
+                ++count;
+            }
+
+            block.face_sizes.push_back( count );
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::insert_obj_block( const ParsedBlock & block )
+{
+    const size_t vertex_base = m_vertices.size();
+    const size_t texcoord_base = m_texcoords.size();
+
+    for( size_t i = 0; i < block.positions.size(); ++i )
+    {
+        m_vertices.push_back( m_mesh.add_vertex( block.positions[i], block.colors[i] ) );
+    }
+
+    m_texcoords.insert( m_texcoords.end(), block.texcoords.begin(), block.texcoords.end() );
+
+    /// 1 based indices count from the start of the file, negative ones back from the face
+    auto resolve = []( const int64_t index, const size_t before )
+    {
+        return index > 0 ? index - 1 : static_cast<int64_t>( before ) + index;
+    };
+
+    size_t corner = 0;
+
+    for( size_t face_index = 0; face_index < block.face_sizes.size(); ++face_index )
+    {
+        const size_t count = block.face_sizes[face_index];
+        const size_t vertices_before = vertex_base + block.face_vertex_counts[face_index];
+        const size_t texcoords_before = texcoord_base + block.face_texcoord_counts[face_index];
+
+        if( count < 3 )
+        {
+            corner += count;
+            continue;
+        }
+
+        m_indices.clear();
+
+        for( size_t i = 0; i < count; ++i )
+        {
+            m_indices.push_back( resolve( block.corners[corner + i], vertices_before ) );
+        }
+
+        const auto face = add_face( m_indices.data(), count );
+
+        if( face == nullptr )
+        {
+            return false;
+        }
+
+        for( auto edge : m_mesh.edges( face ) )
+        {
+            const auto texcoord = block.corner_texcoords[corner++];
+
+            if( texcoord == 0 )
+            {
+                continue;
+            }
+
+            const auto index = resolve( texcoord, texcoords_before );
+
+            if( index < 0 || static_cast<size_t>( index ) >= m_texcoords.size() )
+            {
+                return false;
+            }
+
+            edge->texcoord = m_texcoords[index];
+        }
+    }
+
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::import_obj( const std::string & path )
+{
+    std::ifstream file( path, std::ios::binary );
+
+    if( !file )
+    {
+        return false;
+    }
+
+    begin_import( 0, 0 );
+
+    const bool result = read_lines( file, &MeshImporter::parse_obj_lines, [this]( const ParsedBlock & block )
+    {
+        return insert_obj_block( block );
+    } );
+
+    end_import();
+    return result;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshImporter::type_size( const PlyType type )
+{
+    switch( type )
+    {
+    case PlyType::Int8:
+    case PlyType::UInt8:
+        return 1;
+
+    case PlyType::Int16:
+    case PlyType::UInt16:
+        return 2;
+
+    case PlyType::Int32:
+    case PlyType::UInt32:
+    case PlyType::Float32:
+        return 4;
+
+    case PlyType::Float64:
+        return 8;
+    }
+
+    return 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::read_ply_header( std::istream & file, std::vector<PlyElement> & elements, bool & binary, bool & swap_bytes )
+{
+    auto parse_type = []( const std::string & name, PlyType & type ) -> bool
+    {
+        static const struct { const char * name; PlyType type; } types[] =
+        {
+            { "char", PlyType::Int8 }, { "int8", PlyType::Int8 },
+            { "uchar", PlyType::UInt8 }, { "uint8", PlyType::UInt8 },
+            { "short", PlyType::Int16 }, { "int16", PlyType::Int16 },
+            { "ushort", PlyType::UInt16 }, { "uint16", PlyType::UInt16 },
+            { "int", PlyType::Int32 }, { "int32", PlyType::Int32 },
+            { "uint", PlyType::UInt32 }, { "uint32", PlyType::UInt32 },
+            { "float", PlyType::Float32 }, { "float32", PlyType::Float32 },
+            { "double", PlyType::Float64 }, { "float64", PlyType::Float64 }
+        };
+
+        for( const auto & entry : types )
+        {
+            if( name == entry.name )
+            {
+                type = entry.type;
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    std::string line;
+
+    if( !std::getline( file, line ) || line.compare( 0, 3, "ply" ) != 0 )
+    {
+        return false;
+    }
+
+    bool has_format = false;
+
+    while( std::getline( file, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string keyword;
+        tokens >> keyword;
+
+        if( keyword == "format" )
+        {
+            std::string format;
+            tokens >> format;
+
+            binary = format != "ascii";
+            swap_bytes = ( format == "binary_big_endian" ) != host_is_big_endian();
+            has_format = binary ? format == "binary_little_endian" || format == "binary_big_endian" : true;
+
+            if( !has_format )
+            {
+                return false;
+            }
+        }
+        else if( keyword == "element" )
+        {
+            PlyElement element;
+            std::string count;
+
+            if( !( tokens >> element.name >> count ) )
+            {
+                return false;
+            }
+
+            /// parsed by hand, extracting a size_t would wrap a negative count around
+            const char * p = count.c_str();
+            int64_t value;
+
+            if( !parse_integer( p, value ) || *p != '\0' || value < 0 )
+            {
+                return false;
+            }
+
+            element.count = static_cast<size_t>( value );
+
+            elements.push_back( element );
+        }
+        else if( keyword == "property" )
+        {
+            PlyProperty property;
+            std::string type;
+
+            if( elements.empty() || !( tokens >> type ) )
+            {
+                return false;
+            }
+
+            property.list = type == "list";
+            property.count_type = PlyType::UInt8;
+
+            if( property.list )
+            {
+                std::string count_type;
+
+                if( !( tokens >> count_type >> type ) || !parse_type( count_type, property.count_type ) )
+                {
+                    return false;
+                }
+            }
+
+            if( !parse_type( type, property.type ) || !( tokens >> property.name ) )
+            {
+                return false;
+            }
+
+            elements.back().properties.push_back( property );
+        }
+        else if( keyword == "end_header" )
+        {
+            return has_format;
+        }
+    }
+
+    return false;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshImporter::min_record_size( const PlyElement & element, const bool binary )
+{
+    size_t size = 0;
+
+    for( const auto & property : element.properties )
+    {
+        /// a list can be empty, only its count is certain. In text every value is a digit and a separator
+        size += binary ? type_size( property.list ? property.count_type : property.type ) : 2;
+    }
+
+    /// the last separator of a text file can be missing, yet a text record is a line of at least one number
+    return binary ? size : std::max<size_t>( 1, size - std::min<size_t>( size, 1 ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::vertex_layout( const PlyElement & element, PlyVertexLayout & layout )
+{
+    static const char * const names[][3] =
+    {
+        { "x", nullptr, nullptr }, { "y", nullptr, nullptr }, { "z", nullptr, nullptr },
+        { "red", "r", nullptr }, { "green", "g", nullptr }, { "blue", "b", nullptr }, { "alpha", "a", nullptr },
+        { "s", "u", "texture_u" }, { "t", "v", "texture_v" }
+    };
+
+    int * const slots[] =
+    {
+        &layout.position[0], &layout.position[1], &layout.position[2],
+        &layout.color[0], &layout.color[1], &layout.color[2], &layout.color[3],
+        &layout.texcoord[0], &layout.texcoord[1]
+    };
+
+    for( auto slot : slots )
+    {
+        *slot = -1;
+    }
+
+    layout.color_scale = 1.0f;
+
+    for( size_t i = 0; i < element.properties.size(); ++i )
+    {
+        const auto & property = element.properties[i];
+
+        if( property.list )
+        {
+            return false;
+        }
+
+        for( size_t attribute = 0; attribute < 9; ++attribute )
+        {
+            for( const auto name : names[attribute] )
+            {
+                if( name != nullptr && property.name == name )
+                {
+                    *slots[attribute] = static_cast<int>( i );
+                }
+            }
+        }
+    }
+
+    if( layout.color[0] >= 0 )
+    {
+        const auto type = element.properties[layout.color[0]].type;
+
+        if( type == PlyType::UInt16 || type == PlyType::Int16 )
+        {
+            layout.color_scale = 1.0f / 65535.0f;
+        }
+        else if( type != PlyType::Float32 && type != PlyType::Float64 )
+        {
+            layout.color_scale = 1.0f / 255.0f;
+        }
+    }
+
+    return layout.position[0] >= 0 && layout.position[1] >= 0 && layout.position[2] >= 0;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshImporter::PlyVertex MeshImporter::make_vertex( const PlyVertexLayout & layout, const double * values )
+{
+    PlyVertex vertex;
+    vertex.position = vec3( values[layout.position[0]], values[layout.position[1]], values[layout.position[2]] );
+    vertex.color = vec4( 1.0f, 1.0f, 1.0f, 1.0f );
+    vertex.texcoord = vec2( 0.0f, 0.0f );
+
+    for( int i = 0; i < 4; ++i )
+    {
+        if( layout.color[i] >= 0 )
+        {
+            vertex.color[i] = static_cast<float>( values[layout.color[i]] ) * layout.color_scale;
+        }
+    }
+
+    for( int i = 0; i < 2; ++i )
+    {
+        if( layout.texcoord[i] >= 0 )
+        {
+            vertex.texcoord[i] = static_cast<float>( values[layout.texcoord[i]] );
+        }
+    }
+
+    return vertex;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshImporter::parse_ply_lines( const char * begin, const char * end, ParsedBlock & block )
+{
+    for( const char * p = begin; p < end; next_line( p, end ) )
+    {
+        const size_t first = block.values.size();
+        double value;
+
+        while( parse_number( p, value ) )
+        {
+            block.values.push_back( value );
+        }
+
+        skip_blanks( p );
+
+        if( !is_line_end( *p ) )
+        {
+            block.valid = false;
+            return;
+        }
+
+        /// blank lines carry no element
+        if( block.values.size() > first )
+        {
+            block.line_ends.push_back( block.values.size() );
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::read_ply_ascii( std::istream & file, const std::vector<PlyElement> & elements )
+{
+    size_t element = 0;
+    size_t row = 0;
+    PlyVertexLayout layout;
+
+    if( !elements.empty() && elements[0].name == "vertex" && !vertex_layout( elements[0], layout ) )
+    {
+        return false;
+    }
+
+    const bool result = read_lines( file, &MeshImporter::parse_ply_lines, [&]( const ParsedBlock & block ) -> bool
+    {
+        size_t begin = 0;
+
+        for( const auto end : block.line_ends )
+        {
+            const double * values = block.values.data() + begin;
+            const size_t count = end - begin;
+            begin = end;
+
+            while( element < elements.size() && row == elements[element].count )
+            {
+                ++element;
+                row = 0;
+
+                if( element < elements.size() && elements[element].name == "vertex" && !vertex_layout( elements[element], layout ) )
+                {
+                    return false;
+                }
+            }
+
+            if( element == elements.size() )
+            {
+                /// trailing data after the last element
+                return true;
+            }
+
+            const auto & current = elements[element];
+            ++row;
+
+            if( current.name == "vertex" )
+            {
+                if( count < current.properties.size() )
+                {
+                    return false;
+                }
+
+                const auto vertex = make_vertex( layout, values );
+                m_vertices.push_back( m_mesh.add_vertex( vertex.position, vertex.color ) );
+
+                if( m_vertex_texcoords )
+                {
+                    m_texcoords.push_back( vertex.texcoord );
+                }
+            }
+            else if( current.name == "face" )
+            {
+                m_indices.clear();
+                size_t index = 0;
+
+                for( const auto & property : current.properties )
+                {
+                    if( index >= count )
+                    {
+                        return false;
+                    }
+
+                    if( !property.list )
+                    {
+                        ++index;
+                        continue;
+                    }
+
+                    size_t size;
+
+                    if( !list_length( values[index], count - index - 1, size ) )
+                    {
+                        return false;
+                    }
+
+                    ++index;
+
+                    if( property.name == "vertex_indices" || property.name == "vertex_index" )
+                    {
+                        for( size_t i = 0; i < size; ++i )
+                        {
+                            int64_t vertex;
+
+                            if( !vertex_index( values[index + i], vertex ) )
+                            {
+                                return false;
+                            }
+
+                            m_indices.push_back( vertex );
+                        }
+                    }
+
+                    index += size;
+                }
+
+                if( m_indices.size() >= 3 && add_face( m_indices.data(), m_indices.size() ) == nullptr )
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    } );
+
+    return result;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::read_ply_binary( std::istream & file, const std::vector<PlyElement> & elements, const bool swap_bytes )
+{
+    BinaryReader reader( file, m_chunk_size );
+
+    auto read_value = [swap_bytes]( const char * data, const PlyType type ) -> double
+    {
+        switch( type )
+        {
+        case PlyType::Int8: return load<int8_t>( data, swap_bytes );
+        case PlyType::UInt8: return load<uint8_t>( data, swap_bytes );
+        case PlyType::Int16: return load<int16_t>( data, swap_bytes );
+        case PlyType::UInt16: return load<uint16_t>( data, swap_bytes );
+        case PlyType::Int32: return load<int32_t>( data, swap_bytes );
+        case PlyType::UInt32: return load<uint32_t>( data, swap_bytes );
+        case PlyType::Float32: return load<float>( data, swap_bytes );
+        case PlyType::Float64: return load<double>( data, swap_bytes );
+        }
+
+        return 0.0;
+    };
+
+    /// list counts are integers, a float count type is rejected
+    auto read_count = [swap_bytes]( const char * data, const PlyType type, int64_t & count ) -> bool
+    {
+        switch( type )
+        {
+        case PlyType::Int8: count = load<int8_t>( data, swap_bytes ); return true;
+        case PlyType::UInt8: count = load<uint8_t>( data, swap_bytes ); return true;
+        case PlyType::Int16: count = load<int16_t>( data, swap_bytes ); return true;
+        case PlyType::UInt16: count = load<uint16_t>( data, swap_bytes ); return true;
+        case PlyType::Int32: count = load<int32_t>( data, swap_bytes ); return true;
+        case PlyType::UInt32: count = load<uint32_t>( data, swap_bytes ); return true;
+        case PlyType::Float32:
+        case PlyType::Float64: return false;
+        }
+
+        return false;
+    };
+
+    std::vector<PlyVertex> vertices;
+
+    for( const auto & element : elements )
+    {
+        PlyVertexLayout layout;
+
+        if( element.name == "vertex" && vertex_layout( element, layout ) )
+        {
+            /// fixed size records, converted in batches on the worker threads
+            std::vector<size_t> offsets;
+            size_t record_size = 0;
+
+            for( const auto & property : element.properties )
+            {
+                offsets.push_back( record_size );
+                record_size += type_size( property.type );
+            }
+
+            const size_t batch_size = std::max<size_t>( 1, m_chunk_size / record_size );
+
+            for( size_t first = 0; first < element.count; first += batch_size )
+            {
+                const size_t count = std::min( batch_size, element.count - first );
+                const char * data = reader.take( count * record_size );
+
+                if( data == nullptr )
+                {
+                    return false;
+                }
+
+                vertices.resize( count );
+
+                const unsigned int thread_count = parallel_thread_count( count, m_thread_count, parallel_vertices_per_thread );
+
+                parallel_for_blocks( count, thread_count, [&]( const unsigned int, const size_t begin, const size_t end )
+                {
+                    std::vector<double> values( element.properties.size() );
+
+                    for( size_t i = begin; i < end; ++i )
+                    {
+                        const char * record = data + i * record_size;
+
+                        for( size_t property = 0; property < values.size(); ++property )
+                        {
+                            values[property] = read_value( record + offsets[property], element.properties[property].type );
+                        }
+
+                        vertices[i] = make_vertex( layout, values.data() );
+                    }
+                } );
+
+                for( const auto & vertex : vertices )
+                {
+                    m_vertices.push_back( m_mesh.add_vertex( vertex.position, vertex.color ) );
+
+                    if( m_vertex_texcoords )
+                    {
+                        m_texcoords.push_back( vertex.texcoord );
+                    }
+                }
+            }
+
+            continue;
+        }
+
+        if( element.name == "vertex" )
+        {
+            return false;
+        }
+
+        /// records without properties take no bytes, there is nothing to read
+        if( element.properties.empty() )
+        {
+            continue;
+        }
+
+        /// variable size records, read property by property
+        const bool face = element.name == "face";
+
+        for( size_t row = 0; row < element.count; ++row )
+        {
+            m_indices.clear();
+
+            for( const auto & property : element.properties )
+            {
+                size_t count = 1;
+
+                if( property.list )
+                {
+                    const char * data = reader.take( type_size( property.count_type ) );
+
+                    if( data == nullptr )
+                    {
+                        return false;
+                    }
+
+                    int64_t length = 0;
+
+                    if( !read_count( data, property.count_type, length ) || length < 0 )
+                    {
+                        return false;
+                    }
+
+                    count = static_cast<size_t>( length );
+                }
+
+                const size_t size = type_size( property.type );
+
+                /// the count comes from the file, a list longer than the rest of it is corrupt
+                if( count > reader.remaining() / size )
+                {
+                    return false;
+                }
+
+                const char * data = reader.take( count * size );
+
+                if( data == nullptr )
+                {
+                    return false;
+                }
+
+                if( face && property.list && ( property.name == "vertex_indices" || property.name == "vertex_index" ) )
+                {
+                    for( size_t i = 0; i < count; ++i )
+                    {
+                        int64_t vertex;
+
+                        if( !vertex_index( read_value( data + i * size, property.type ), vertex ) )
+                        {
+                            return false;
+                        }
+
+                        m_indices.push_back( vertex );
+                    }
+                }
+            }
+
+            if( face && m_indices.size() >= 3 && add_face( m_indices.data(), m_indices.size() ) == nullptr )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshImporter::import_ply( const std::string & path )
+{
+    std::ifstream file( path, std::ios::binary );
+
+    if( !file )
+    {
+        return false;
+    }
+
+    std::vector<PlyElement> elements;
+    bool binary = false;
+    bool swap_bytes = false;
+
+    if( !read_ply_header( file, elements, binary, swap_bytes ) )
+    {
+        return false;
+    }
+
+    size_t vertex_count = 0;
+    size_t face_count = 0;
+    bool texcoords = false;
+
+    /// the counts come from the file, the storage reserved for them must not outgrow the file itself.
+    /// A record takes at least min_record_size bytes, more records than fit are a corrupt header
+    const size_t file_left = bytes_left( file );
+    size_t file_needed = 0;
+
+    for( const auto & element : elements )
+    {
+        const size_t record_size = min_record_size( element, binary );
+
+        if( record_size > 0 && ( element.count > file_left / record_size || element.count * record_size > file_left - file_needed ) )
+        {
+            return false;
+        }
+
+        file_needed += element.count * record_size;
+
+        if( element.name == "vertex" )
+        {
+            PlyVertexLayout layout;
+            vertex_count += element.count;
+            texcoords = texcoords || ( vertex_layout( element, layout ) && layout.texcoord[0] >= 0 );
+        }
+        else if( element.name == "face" )
+        {
+            face_count += element.count;
+        }
+    }
+
+    begin_import( vertex_count, face_count );
+    m_vertex_texcoords = texcoords;
+    m_texcoords.reserve( texcoords ? vertex_count : 0 );
+
+    const bool result = binary ? read_ply_binary( file, elements, swap_bytes ) : read_ply_ascii( file, elements );
+
+    end_import();
+    return result;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <istream>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+#include "LinkedMeshBuilder.hpp"
+
+/// Streaming OBJ and PLY reader building LinkedMesh topology directly.
+/// The file is read in chunks of chunk_size bytes; the lines of a chunk are parsed on several
+/// threads and inserted in file order, so only one chunk of text and its parsed values are held
+/// at a time. Halfedges are paired through LinkedMeshBuilder, whose edge hash drops every pair
+/// once it is linked and only keeps the open front of the mesh.
+/// Supported: OBJ v (with optional rgb), vt and f with positive or negative indices;
+/// PLY ascii and binary with vertex x y z, red green blue alpha, s t / u v and face vertex_indices.
+class MeshImporter
+{
+   public:
+
+      typedef LinkedMesh::VertexHandle VertexHandle;
+      typedef LinkedMesh::FaceHandle FaceHandle;
+
+      /// thread_count 0 uses every hardware thread
+      MeshImporter( LinkedMesh & mesh, const size_t chunk_size = 16 << 20, const unsigned int thread_count = 0 );
+
+      ~MeshImporter();
+
+      /// Import an .obj or .ply file by its extension. Returns false if it can not be read
+      bool import( const std::string & path );
+
+      /// Append the faces of an OBJ file to the mesh. Returns false if it can not be read
+      bool import_obj( const std::string & path );
+
+      /// Append the faces of a PLY file to the mesh, storage is reserved from the header counts.
+      /// Returns false if it can not be read, or before touching the mesh when the header counts
+      /// are negative or more than the rest of the file can hold
+      bool import_ply( const std::string & path );
+
+      /// vertices and faces added by the last import
+      inline size_t vertex_count() const { return m_vertices.size(); }
+      inline size_t face_count() const { return m_face_count; }
+
+      /// halfedges of the last import without an opposing halfedge
+      inline size_t open_edge_count() const { return m_open_edge_count; }
+
+   private:
+
+      /// values parsed by one thread from a run of whole lines
+      struct ParsedBlock
+      {
+         std::vector<vec3> positions;
+         std::vector<vec4> colors;
+         std::vector<vec2> texcoords;
+
+         /// OBJ: corner indices as written in the file ( 1 based or negative ), 0 when missing
+         std::vector<int64_t> corners;
+         std::vector<int64_t> corner_texcoords;
+
+         /// OBJ: corners of every face and the vertices and texcoords of the block before it
+         std::vector<uint32_t> face_sizes;
+         std::vector<uint32_t> face_vertex_counts;
+         std::vector<uint32_t> face_texcoord_counts;
+
+         /// PLY ascii: every number of every line, and where each line ends
+         std::vector<double> values;
+         std::vector<size_t> line_ends;
+
+         bool valid;
+
+         void clear();
+      };
+
+      enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+      struct PlyProperty
+      {
+         std::string name;
+         PlyType type;
+
+         /// list properties have a count of type count_type before the values
+         bool list;
+         PlyType count_type;
+      };
+
+      struct PlyElement
+      {
+         std::string name;
+         size_t count;
+         std::vector<PlyProperty> properties;
+      };
+
+      /// a vertex as read from a PLY vertex element
+      struct PlyVertex
+      {
+         vec3 position;
+         vec4 color;
+         vec2 texcoord;
+      };
+
+      /// where the PLY vertex attributes are in a vertex row, -1 when missing
+      struct PlyVertexLayout
+      {
+         int position[3];
+         int color[4];
+         int texcoord[2];
+
+         /// scale of the color values, 1/255 for integer colors
+         float color_scale;
+      };
+
+      /// read the file in chunks of whole lines, parse [begin, end) of each on the worker threads
+      /// and insert the blocks in file order
+      template<typename Parse, typename Insert>
+      bool read_lines( std::istream & file, Parse parse, Insert insert );
+
+      /// parse the OBJ lines in [begin, end), which ends with a line break
+      static void parse_obj_lines( const char * begin, const char * end, ParsedBlock & block );
+
+      /// parse the numbers of the PLY lines in [begin, end), which ends with a line break
+      static void parse_ply_lines( const char * begin, const char * end, ParsedBlock & block );
+
+      /// add the vertices and faces of a parsed OBJ block to the mesh
+      bool insert_obj_block( const ParsedBlock & block );
+
+      bool read_ply_header( std::istream & file, std::vector<PlyElement> & elements, bool & binary, bool & swap_bytes );
+
+      bool read_ply_ascii( std::istream & file, const std::vector<PlyElement> & elements );
+
+      bool read_ply_binary( std::istream & file, const std::vector<PlyElement> & elements, const bool swap_bytes );
+
+      /// add a face from 0 based indices of the vertices of this import, nullptr if one is out of range
+      FaceHandle add_face( const int64_t * indices, const size_t count );
+
+      /// reset the per import state and reserve the mesh
+      void begin_import( const size_t vertex_count, const size_t face_count );
+
+      void end_import();
+
+      static size_t type_size( const PlyType type );
+
+      /// fewest bytes a record of the element can take in the file, 0 for binary records without properties
+      static size_t min_record_size( const PlyElement & element, const bool binary );
+
+      /// false if the element has list properties or no position
+      static bool vertex_layout( const PlyElement & element, PlyVertexLayout & layout );
+
+      static PlyVertex make_vertex( const PlyVertexLayout & layout, const double * values );
+
+      LinkedMesh & m_mesh;
+
+      LinkedMeshBuilder m_builder;
+
+      size_t m_chunk_size;
+
+      unsigned int m_thread_count;
+
+      /// handles of the vertices of this import by file index
+      std::vector<VertexHandle> m_vertices;
+
+      /// texcoords of this import by file index
+      std::vector<vec2> m_texcoords;
+
+      /// m_texcoords holds one texcoord per vertex ( PLY s t ), applied to every corner of the vertex
+      bool m_vertex_texcoords;
+
+      size_t m_face_count;
+
+      size_t m_open_edge_count;
+
+      /// open halfedges of the builder before this import
+      size_t m_open_edge_base;
+
+      /// one parse result per worker thread, reused between chunks
+      std::vector<ParsedBlock> m_blocks;
+
+      /// reused face corners
+      std::vector<VertexHandle> m_corners;
+
+      /// reused resolved face indices
+      std::vector<int64_t> m_indices;
+};
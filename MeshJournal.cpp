@@ -0,0 +1,468 @@
+#include "core/mesh/MeshJournal.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    /// smallest share of elements worth a thread of its own when comparing
+    const size_t parallel_records_per_thread = 16384;
+
+    template<typename Record>
+    inline size_t vector_bytes( const std::vector<Record> & vector )
+    {
+        return vector.capacity() * sizeof( Record );
+    }
+
+    /// resize a pool of elements, new elements are unlinked and get their id as index
+    template<typename Pool, typename Make>
+    void resize_pool( Pool & pool, const size_t size, Make make )
+    {
+        while( pool.size() > size )
+        {
+            pool.pop_back();
+        }
+
+        while( pool.size() < size )
+        {
+            make( pool.size() );
+        }
+    }
+
+    /// replace everything after prefix with entries
+    void replace_tail( std::vector<int> & list, const uint32_t prefix, const std::vector<int> & entries )
+    {
+        list.resize( prefix );
+        list.insert( list.end(), entries.begin(), entries.end() );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshJournal::MeshJournal( LinkedMesh & mesh, const unsigned int thread_count ) :
+    m_mesh( mesh ),
+    m_thread_count( thread_count ),
+    m_revision( 0 )
+{
+    clear();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshJournal::~MeshJournal()
+{
+    m_mesh.m_change_log = LinkedMesh::ChangeLog();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshJournal::start_log()
+{
+    auto & log = m_mesh.m_change_log;
+
+    log.vertices.clear();
+    log.edges.clear();
+    log.faces.clear();
+
+    log.kept_free_vertices = m_mesh.m_free_vertices.size();
+    log.kept_free_edges = m_mesh.m_free_edges.size();
+    log.kept_free_faces = m_mesh.m_free_faces.size();
+
+    m_revision = m_mesh.revision();
+    log.start = m_revision;
+    log.revision = m_revision;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshJournal::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+
+    m_vertices.clear();
+    m_edges.clear();
+    m_faces.clear();
+
+    /// everything differs from nothing, which leaves the committed records equal to the mesh
+    Operation operation;
+    compare( m_mesh.m_vertices, m_vertices, operation.vertices );
+    compare( m_mesh.m_edges, m_edges, operation.edges );
+    compare( m_mesh.m_faces, m_faces, operation.faces );
+
+    apply_to_records( operation, true );
+
+    m_free_vertices = m_mesh.m_free_vertices;
+    m_free_edges = m_mesh.m_free_edges;
+    m_free_faces = m_mesh.m_free_faces;
+
+    start_log();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Record, typename Pool>
+void MeshJournal::compare( const Pool & pool, const std::vector<Record> & committed, Changes<Record> & changes ) const
+{
+    changes.before_size = static_cast<uint32_t>( committed.size() );
+    changes.after_size = static_cast<uint32_t>( pool.size() );
+
+    compare_range( pool, committed, 0, std::max( pool.size(), committed.size() ), changes );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Record, typename Pool>
+void MeshJournal::compare( const Pool & pool, const std::vector<Record> & committed, std::vector<LinkedMesh::ChangeLog::Range> ranges, Changes<Record> & changes ) const
+{
+    changes.before_size = static_cast<uint32_t>( committed.size() );
+    changes.after_size = static_cast<uint32_t>( pool.size() );
+
+    const auto size = std::max( pool.size(), committed.size() );
+    const auto common = std::min( pool.size(), committed.size() );
+
+    /// elements that only exist on one side always changed, grown ones are logged but shrinking is not
+    if( common < size )
+    {
+        ranges.push_back( { static_cast<uint32_t>( common ), static_cast<uint32_t>( size - common ) } );
+    }
+
+    std::sort( ranges.begin(), ranges.end(), []( const LinkedMesh::ChangeLog::Range & a, const LinkedMesh::ChangeLog::Range & b )
+    {
+        return a.first < b.first;
+    } );
+
+    /// overlapping ranges are visited once, in id order
+    size_t begin = 0;
+    size_t end = 0;
+
+    for( const auto & range : ranges )
+    {
+        if( range.first > end )
+        {
+            compare_range( pool, committed, begin, end, changes );
+            begin = range.first;
+        }
+
+        end = std::min<size_t>( std::max<size_t>( end, size_t( range.first ) + range.count ), size );
+    }
+
+    compare_range( pool, committed, begin, end, changes );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Record, typename Pool>
+void MeshJournal::compare_range( const Pool & pool, const std::vector<Record> & committed, const size_t first, const size_t last, Changes<Record> & changes ) const
+{
+    if( first >= last )
+    {
+        return;
+    }
+
+    const auto count = last - first;
+    const auto threads = parallel_thread_count( count, m_thread_count, parallel_records_per_thread );
+
+    /// changed runs of every block, joined in order afterwards
+    std::vector<Changes<Record>> blocks( threads );
+
+    parallel_for_blocks( count, threads, [&]( const unsigned int block, const size_t begin, const size_t end )
+    {
+        auto & local = blocks[block];
+
+        Record zero;
+        std::memset( &zero, 0, sizeof( zero ) );
+
+        Record current;
+
+        for( size_t i = first + begin; i < first + end; ++i )
+        {
+            if( i < pool.size() )
+            {
+                m_mesh.store( pool[i], current );
+            }
+            else
+            {
+                current = zero;
+            }
+
+            /// elements that only exist on one side always count as changed
+            const auto & before = i < committed.size() ? committed[i] : zero;
+
+            if( i < committed.size() && i < pool.size() && std::memcmp( &current, &before, sizeof( Record ) ) == 0 ) continue;
+
+            if( !local.ranges.empty() && local.ranges.back().first + local.ranges.back().count == i )
+            {
+                ++local.ranges.back().count;
+            }
+            else
+            {
+                local.ranges.push_back( { static_cast<uint32_t>( i ), 1, static_cast<uint32_t>( local.before.size() ) } );
+            }
+
+            local.before.push_back( before );
+            local.after.push_back( current );
+        }
+    } );
+
+    for( const auto & local : blocks )
+    {
+        const auto offset = static_cast<uint32_t>( changes.before.size() );
+
+        for( auto range : local.ranges )
+        {
+            auto & ranges = changes.ranges;
+
+            if( !ranges.empty() && ranges.back().first + ranges.back().count == range.first )
+            {
+                ranges.back().count += range.count;
+            }
+            else
+            {
+                range.offset += offset;
+                ranges.push_back( range );
+            }
+        }
+
+        changes.before.insert( changes.before.end(), local.before.begin(), local.before.end() );
+        changes.after.insert( changes.after.end(), local.after.begin(), local.after.end() );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshJournal::uncommitted_changes( Operation & operation ) const
+{
+    const auto & log = m_mesh.m_change_log;
+    const bool logged = log.start == m_revision && log.revision == m_mesh.revision();
+
+    if( logged )
+    {
+        compare( m_mesh.m_vertices, m_vertices, log.vertices, operation.vertices );
+        compare( m_mesh.m_edges, m_edges, log.edges, operation.edges );
+        compare( m_mesh.m_faces, m_faces, log.faces, operation.faces );
+    }
+    else
+    {
+        compare( m_mesh.m_vertices, m_vertices, operation.vertices );
+        compare( m_mesh.m_edges, m_edges, operation.edges );
+        compare( m_mesh.m_faces, m_faces, operation.faces );
+    }
+
+    /// the logged free lists only popped below their kept length and pushed on top of that
+    auto compare_free_list = []( const std::vector<int> & committed, const std::vector<int> & current, const size_t kept, FreeListChanges & changes )
+    {
+        const auto size = std::min( committed.size(), current.size() );
+        const auto start = std::min( kept, size );
+        const auto mismatch = std::mismatch( committed.begin() + start, committed.begin() + size, current.begin() + start );
+        const auto prefix = mismatch.first - committed.begin();
+
+        changes.prefix = static_cast<uint32_t>( prefix );
+        changes.before.assign( committed.begin() + prefix, committed.end() );
+        changes.after.assign( current.begin() + prefix, current.end() );
+    };
+
+    compare_free_list( m_free_vertices, m_mesh.m_free_vertices, logged ? log.kept_free_vertices : 0, operation.free_vertices );
+    compare_free_list( m_free_edges, m_mesh.m_free_edges, logged ? log.kept_free_edges : 0, operation.free_edges );
+    compare_free_list( m_free_faces, m_mesh.m_free_faces, logged ? log.kept_free_faces : 0, operation.free_faces );
+
+    return !operation.vertices.empty() || !operation.edges.empty() || !operation.faces.empty() ||
+           !operation.free_vertices.empty() || !operation.free_edges.empty() || !operation.free_faces.empty();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshJournal::commit()
+{
+    Operation operation;
+
+    if( !uncommitted_changes( operation ) )
+    {
+        start_log();
+        return false;
+    }
+
+    apply_to_records( operation, true );
+    start_log();
+
+    m_undo.push_back( std::move( operation ) );
+    m_redo.clear();
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshJournal::undo()
+{
+    if( m_undo.empty() )
+    {
+        return false;
+    }
+
+    revert();
+
+    apply( m_undo.back(), false );
+
+    m_redo.push_back( std::move( m_undo.back() ) );
+    m_undo.pop_back();
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+bool MeshJournal::redo()
+{
+    if( m_redo.empty() )
+    {
+        return false;
+    }
+
+    revert();
+
+    apply( m_redo.back(), true );
+
+    m_undo.push_back( std::move( m_redo.back() ) );
+    m_redo.pop_back();
+    return true;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshJournal::revert()
+{
+    if( m_mesh.revision() == m_revision )
+    {
+        return;
+    }
+
+    Operation uncommitted;
+
+    if( uncommitted_changes( uncommitted ) )
+    {
+        apply( uncommitted, false );
+    }
+    else
+    {
+        start_log();
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshJournal::apply( const Operation & operation, const bool forward )
+{
+    auto & mesh = m_mesh;
+
+    /// dirty tracking points into the pools, which may shrink
+    for( const auto vertex : mesh.m_dirty_vertices )
+    {
+        vertex->dirty = false;
+    }
+
+    for( const auto face : mesh.m_dirty_faces )
+    {
+        face->dirty = false;
+    }
+
+    mesh.m_dirty_vertices.clear();
+    mesh.m_dirty_faces.clear();
+
+    /// every element must exist before links to it are restored
+    const auto & vertices = operation.vertices;
+    const auto & edges = operation.edges;
+    const auto & faces = operation.faces;
+
+    resize_pool( mesh.m_vertices, forward ? vertices.after_size : vertices.before_size, [&]( const size_t id )
+    {
+        mesh.m_vertices.emplace_back( static_cast<uint>( id ), vec3() );
+    } );
+
+    resize_pool( mesh.m_edges, forward ? edges.after_size : edges.before_size, [&]( const size_t id )
+    {
+        mesh.m_edges.emplace_back( static_cast<uint>( id ), nullptr );
+    } );
+
+    resize_pool( mesh.m_faces, forward ? faces.after_size : faces.before_size, [&]( const size_t id )
+    {
+        mesh.m_faces.emplace_back( static_cast<uint>( id ), nullptr );
+    } );
+
+    restore_records( mesh.m_vertices, vertices, forward );
+    restore_records( mesh.m_edges, edges, forward );
+    restore_records( mesh.m_faces, faces, forward );
+
+    replace_tail( mesh.m_free_vertices, operation.free_vertices.prefix, forward ? operation.free_vertices.after : operation.free_vertices.before );
+    replace_tail( mesh.m_free_edges, operation.free_edges.prefix, forward ? operation.free_edges.after : operation.free_edges.before );
+    replace_tail( mesh.m_free_faces, operation.free_faces.prefix, forward ? operation.free_faces.after : operation.free_faces.before );
+
+    mesh.touch();
+    mesh.m_export_layout_valid = false;
+
+    apply_to_records( operation, forward );
+
+    start_log();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Record, typename Pool>
+void MeshJournal::restore_records( Pool & pool, const Changes<Record> & changes, const bool forward )
+{
+    const auto & records = forward ? changes.after : changes.before;
+
+    for( const auto & range : changes.ranges )
+    {
+        const auto end = std::min<size_t>( range.first + range.count, pool.size() );
+
+        for( size_t id = range.first; id < end; ++id )
+        {
+            m_mesh.restore( pool[id], records[range.offset + id - range.first] );
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+template<typename Record>
+void MeshJournal::update_records( std::vector<Record> & committed, const Changes<Record> & changes, const bool forward )
+{
+    const auto & records = forward ? changes.after : changes.before;
+
+    committed.resize( forward ? changes.after_size : changes.before_size );
+
+    for( const auto & range : changes.ranges )
+    {
+        const auto end = std::min<size_t>( range.first + range.count, committed.size() );
+
+        for( size_t id = range.first; id < end; ++id )
+        {
+            committed[id] = records[range.offset + id - range.first];
+        }
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshJournal::apply_to_records( const Operation & operation, const bool forward )
+{
+    update_records( m_vertices, operation.vertices, forward );
+    update_records( m_edges, operation.edges, forward );
+    update_records( m_faces, operation.faces, forward );
+
+    replace_tail( m_free_vertices, operation.free_vertices.prefix, forward ? operation.free_vertices.after : operation.free_vertices.before );
+    replace_tail( m_free_edges, operation.free_edges.prefix, forward ? operation.free_edges.after : operation.free_edges.before );
+    replace_tail( m_free_faces, operation.free_faces.prefix, forward ? operation.free_faces.after : operation.free_faces.before );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshJournal::allocated_bytes() const
+{
+    size_t bytes = vector_bytes( m_vertices ) + vector_bytes( m_edges ) + vector_bytes( m_faces ) +
+                   vector_bytes( m_free_vertices ) + vector_bytes( m_free_edges ) + vector_bytes( m_free_faces );
+
+    auto operation_bytes = []( const Operation & operation ) -> size_t
+    {
+        return vector_bytes( operation.vertices.ranges ) + vector_bytes( operation.vertices.before ) + vector_bytes( operation.vertices.after ) +
+               vector_bytes( operation.edges.ranges ) + vector_bytes( operation.edges.before ) + vector_bytes( operation.edges.after ) +
+               vector_bytes( operation.faces.ranges ) + vector_bytes( operation.faces.before ) + vector_bytes( operation.faces.after ) +
+               vector_bytes( operation.free_vertices.before ) + vector_bytes( operation.free_vertices.after ) +
+               vector_bytes( operation.free_edges.before ) + vector_bytes( operation.free_edges.after ) +
+               vector_bytes( operation.free_faces.before ) + vector_bytes( operation.free_faces.after );
+    };
+
+    for( const auto & operation : m_undo )
+    {
+        bytes += operation_bytes( operation );
+    }
+
+    for( const auto & operation : m_redo )
+    {
+        bytes += operation_bytes( operation );
+    }
+
+    return bytes + ( m_undo.capacity() + m_redo.capacity() ) * sizeof( Operation );
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "LinkedMesh.hpp"
+#include "mesh_snapshot.hpp"
+
+/// Undo and redo history of a LinkedMesh.
+/// The journal keeps the records of the mesh as of the last commit(). Committing compares the mesh
+/// with them and stores only what changed: runs of consecutive element ids with their records before
+/// and after, the element counts and the changed tails of the free lists. Undo and redo write those
+/// records back, after dropping what changed since the last commit the same way.
+/// The mutators of LinkedMesh (add_*, link_edges, bridge_edges, extrude_*, set_color, set_texcoord,
+/// compute_normal(s), reset and append) log the ids they write, so the comparison only visits those
+/// and costs the size of the change. Anything else, decimate, subdivide, compact, release_vertex and
+/// the builder stitches among them, or an edit through a handle reported by mark_dirty, ends the log
+/// until the next commit, undo or redo: the comparison then falls back to one parallel pass over the
+/// whole mesh. Edits made through handles are only seen through mark_dirty, as for LinkedMesh::revision().
+/// The committed records are a full copy of every element, so the journal holds about as much memory
+/// as the mesh itself on top of the history; see allocated_bytes().
+/// Every handle into the mesh may be invalid after undo or redo, look elements up by id again.
+class MeshJournal
+{
+   public:
+
+      /// starts with an empty history at the current state of mesh; commits compare on thread_count threads
+      explicit MeshJournal( LinkedMesh & mesh, const unsigned int thread_count = 0 );
+
+      /// stops the change log of the mesh
+      ~MeshJournal();
+
+      MeshJournal( const MeshJournal & ) = delete;
+      MeshJournal & operator=( const MeshJournal & ) = delete;
+
+      /// Record everything changed since the last commit, undo or redo as one operation and drop the redo
+      /// history. Returns false when nothing changed
+      bool commit();
+
+      /// Revert the mesh to the state before the last committed operation. Changes made since the last
+      /// commit are lost. Returns false when there is nothing to undo
+      bool undo();
+
+      /// Apply the last undone operation again. Changes made since the last commit are lost. Returns false
+      /// when there is nothing to redo
+      bool redo();
+
+      inline size_t undo_count() const { return m_undo.size(); }
+      inline size_t redo_count() const { return m_redo.size(); }
+
+      /// forget the history and start over at the current state of the mesh
+      void clear();
+
+      /// bytes held by the journal: the committed records and every operation
+      size_t allocated_bytes() const;
+
+   private:
+
+      /// run of changed elements, its records are at offset in the before and after arrays
+      struct Range
+      {
+         uint32_t first;
+         uint32_t count;
+         uint32_t offset;
+      };
+
+      /// changed elements of one kind. Elements past a size are stored as zero records
+      template<typename Record>
+      struct Changes
+      {
+         uint32_t before_size = 0;
+         uint32_t after_size = 0;
+         std::vector<Range> ranges;
+         std::vector<Record> before;
+         std::vector<Record> after;
+
+         bool empty() const { return before_size == after_size && ranges.empty(); }
+      };
+
+      /// a free list keeps its first prefix entries and has the rest replaced
+      struct FreeListChanges
+      {
+         uint32_t prefix = 0;
+         std::vector<int> before;
+         std::vector<int> after;
+
+         bool empty() const { return before == after; }
+      };
+
+      struct Operation
+      {
+         Changes<mesh_snapshot::VertexRecord> vertices;
+         Changes<mesh_snapshot::EdgeRecord> edges;
+         Changes<mesh_snapshot::FaceRecord> faces;
+
+         FreeListChanges free_vertices;
+         FreeListChanges free_edges;
+         FreeListChanges free_faces;
+      };
+
+      /// compare every element of the mesh with the committed records
+      template<typename Record, typename Pool>
+      void compare( const Pool & pool, const std::vector<Record> & committed, Changes<Record> & changes ) const;
+
+      /// compare only the elements in the logged ranges and those past the smaller of the two sizes
+      template<typename Record, typename Pool>
+      void compare( const Pool & pool, const std::vector<Record> & committed, std::vector<LinkedMesh::ChangeLog::Range> ranges, Changes<Record> & changes ) const;
+
+      /// compare the elements [begin, end) and add the changed runs to changes
+      template<typename Record, typename Pool>
+      void compare_range( const Pool & pool, const std::vector<Record> & committed, const size_t begin, const size_t end, Changes<Record> & changes ) const;
+
+      /// everything that changed since the committed records, through the change log while it is complete.
+      /// Returns false when nothing did
+      bool uncommitted_changes( Operation & operation ) const;
+
+      /// the mesh matches the committed records, start a new change log at its revision
+      void start_log();
+
+      /// drop the changes made to the mesh since the committed records, nothing to do while the
+      /// revision is unchanged
+      void revert();
+
+      /// bring the mesh and the committed records to one side of operation
+      void apply( const Operation & operation, const bool forward );
+
+      /// write one side of changes into the pool, which already has its size
+      template<typename Record, typename Pool>
+      void restore_records( Pool & pool, const Changes<Record> & changes, const bool forward );
+
+      /// bring one kind of committed records to one side of changes
+      template<typename Record>
+      static void update_records( std::vector<Record> & committed, const Changes<Record> & changes, const bool forward );
+
+      /// bring the committed records and free lists to one side of operation, the mesh is left alone
+      void apply_to_records( const Operation & operation, const bool forward );
+
+      LinkedMesh & m_mesh;
+
+      unsigned int m_thread_count;
+
+      /// records of the mesh at the last commit, undo or redo
+      std::vector<mesh_snapshot::VertexRecord> m_vertices;
+      std::vector<mesh_snapshot::EdgeRecord> m_edges;
+      std::vector<mesh_snapshot::FaceRecord> m_faces;
+      std::vector<int> m_free_vertices;
+      std::vector<int> m_free_edges;
+      std::vector<int> m_free_faces;
+
+      /// revision of the mesh when it last matched the committed records, the change log started there
+      uint64_t m_revision;
+
+      std::vector<Operation> m_undo;
+      std::vector<Operation> m_redo;
+};
@@ -0,0 +1,153 @@
+#include "core/mesh/MeshVersion.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+const size_t MeshVersion::chunk_size;
+
+namespace
+{
+    /// number of chunks two versions hold at the same place
+    template<typename Chunk>
+    size_t count_shared( const std::vector<std::shared_ptr<const Chunk>> & left, const std::vector<std::shared_ptr<const Chunk>> & right )
+    {
+        size_t count = 0;
+
+        for( size_t i = 0; i < std::min( left.size(), right.size() ); ++i )
+        {
+            count += left[i] == right[i] ? 1 : 0;
+        }
+
+        return count;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshVersion::triangle_vertex_count() const
+{
+    size_t count = 0;
+
+    for( size_t i = 0; i < m_face_count; ++i )
+    {
+        const auto first = face( i ).edge;
+
+        if( first == mesh_snapshot::invalid_index ) continue;
+
+        size_t edges = 0;
+        auto id = first;
+
+        do
+        {
+            ++edges;
+            id = edge( id ).next;
+        }
+        while( id != first );
+
+        count += edges + edges / 3 + 1;
+    }
+
+    return count;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void MeshVersion::triangles( std::vector<Mesh::Vertex> & vertices ) const
+{
+    /// size the output once, then fill it without growing
+    const auto offset = vertices.size();
+    vertices.resize( offset + triangle_vertex_count() );
+    auto out = vertices.data() + offset;
+
+    for( size_t i = 0; i < m_face_count; ++i )
+    {
+        const auto & face_record = face( i );
+        const auto first = face_record.edge;
+
+        if( first == mesh_snapshot::invalid_index ) continue;
+
+        const auto normal = vec3( face_record.normal[0], face_record.normal[1], face_record.normal[2] );
+
+        auto emit = [&]( const mesh_snapshot::EdgeRecord & edge_record, const vec3 & barycenter )
+        {
+            const auto & vertex_record = vertex( edge_record.vertex );
+            const auto position = vec4( vertex_record.position[0], vertex_record.position[1], vertex_record.position[2], 1.0f );
+            const auto color = vec4( vertex_record.color[0], vertex_record.color[1], vertex_record.color[2], vertex_record.color[3] );
+            const auto texcoord = vec2( edge_record.texcoord[0], edge_record.texcoord[1] );
+
+            *out++ = Mesh::Vertex( position, color, normal, texcoord, barycenter, vertex_record.light );
+        };
+
+        /// same corners as LinkedMesh::write_triangles
+        auto id = first;
+        unsigned int vertex_count = 0;
+        unsigned int barycenter_index = 0;
+        vec3 barycenter;
+
+        do
+        {
+            const auto & edge_record = edge( id );
+
+            barycenter = vec3( 0.0f, 0.0f, 0.0f );
+            barycenter[barycenter_index++] = 1.0f;
+            emit( edge_record, barycenter );
+
+            if( ++vertex_count % 3 == 0 )
+            {
+                barycenter_index = 0;
+                barycenter = vec3( 0.0f, 0.0f, 0.0f );
+                barycenter[barycenter_index++] = 1.0f;
+                emit( edge_record, barycenter );
+            }
+
+            id = edge_record.next;
+        }
+        while( id != first );
+
+        emit( edge( first ), vec3( 0.0f, 0.0f, 1.0f ) );
+    }
+
+    assert( out == vertices.data() + vertices.size() );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshVersion::chunk_count() const
+{
+    return m_vertex_chunks.size() + m_edge_chunks.size() + m_face_chunks.size();
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+size_t MeshVersion::shared_chunk_count( const MeshVersion & other ) const
+{
+    return count_shared( m_vertex_chunks, other.m_vertex_chunks ) +
+           count_shared( m_edge_chunks, other.m_edge_chunks ) +
+           count_shared( m_face_chunks, other.m_face_chunks );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+MeshPublisher::MeshPublisher( const LinkedMesh & mesh, const unsigned int thread_count ) :
+    m_mesh( mesh ),
+    m_thread_count( thread_count )
+{
+
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const MeshVersion> MeshPublisher::publish()
+{
+    const auto previous = std::atomic_load( &m_current );
+
+    if( previous && previous->revision() == m_mesh.revision() )
+    {
+        return previous;
+    }
+
+    const auto version = m_mesh.make_version( previous.get(), m_thread_count );
+    std::atomic_store( &m_current, version );
+
+    return version;
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const MeshVersion> MeshPublisher::current() const
+{
+    return std::atomic_load( &m_current );
+}
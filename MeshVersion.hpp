@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+#include "glm/glm.hpp"
+
+#include "LinkedMesh.hpp"
+#include "mesh_snapshot.hpp"
+
+/// Immutable copy of a LinkedMesh at one revision, for readers on other threads.
+/// Elements are stored as snapshot records, links as indices, in chunks of chunk_size records. A chunk
+/// is shared by every version in which it did not change, so publishing a version after a local edit
+/// only allocates the chunks that edit touched. A version never changes once made; readers holding it
+/// need no locks, whatever the writer does to the mesh meanwhile.
+class MeshVersion
+{
+   public:
+
+      /// records per chunk, the block size of snapshot files
+      static const size_t chunk_size = 256;
+
+      template<typename Record>
+      struct Chunk
+      {
+         Record records[chunk_size];
+      };
+
+      typedef Chunk<mesh_snapshot::VertexRecord> VertexChunk;
+      typedef Chunk<mesh_snapshot::EdgeRecord> EdgeChunk;
+      typedef Chunk<mesh_snapshot::FaceRecord> FaceChunk;
+
+      MeshVersion( const MeshVersion & ) = delete;
+      MeshVersion & operator=( const MeshVersion & ) = delete;
+
+      /// LinkedMesh::revision() this version was made at
+      inline uint64_t revision() const { return m_revision; }
+
+      /// allocated elements, including the ones on the free lists
+      inline size_t vertex_count() const { return m_vertex_count; }
+      inline size_t edge_count() const { return m_edge_count; }
+      inline size_t face_count() const { return m_face_count; }
+
+      /// element by id, links are ids as well; free elements have flag_initialized clear
+      inline const mesh_snapshot::VertexRecord & vertex( const size_t id ) const { return m_vertex_chunks[id / chunk_size]->records[id % chunk_size]; }
+      inline const mesh_snapshot::EdgeRecord & edge( const size_t id ) const { return m_edge_chunks[id / chunk_size]->records[id % chunk_size]; }
+      inline const mesh_snapshot::FaceRecord & face( const size_t id ) const { return m_face_chunks[id / chunk_size]->records[id % chunk_size]; }
+
+      /// number of vertices triangles( vertices ) emits
+      size_t triangle_vertex_count() const;
+
+      /// Fill mesh vertex buffer, the same output LinkedMesh::triangles( vertices ) gave at this revision
+      void triangles( std::vector<Mesh::Vertex> & vertices ) const;
+
+      /// chunks making up this version
+      size_t chunk_count() const;
+
+      /// chunks this version shares with other
+      size_t shared_chunk_count( const MeshVersion & other ) const;
+
+   private:
+
+      friend class LinkedMesh;
+
+      MeshVersion() {}
+
+      uint64_t m_revision = 0;
+
+      size_t m_vertex_count = 0;
+      size_t m_edge_count = 0;
+      size_t m_face_count = 0;
+
+      std::vector<std::shared_ptr<const VertexChunk>> m_vertex_chunks;
+      std::vector<std::shared_ptr<const EdgeChunk>> m_edge_chunks;
+      std::vector<std::shared_ptr<const FaceChunk>> m_face_chunks;
+};
+
+/// Hands the latest MeshVersion of a mesh from one writer thread to any number of reader threads.
+/// The writer edits the mesh as usual and calls publish() when readers should see the edits; readers
+/// call current() and traverse what it returns for as long as they like. Swapping the current version
+/// is atomic, readers never wait for the writer to finish an edit
+class MeshPublisher
+{
+   public:
+
+      /// thread_count is used to encode versions, 0 uses every hardware thread
+      explicit MeshPublisher( const LinkedMesh & mesh, const unsigned int thread_count = 0 );
+
+      MeshPublisher( const MeshPublisher & ) = delete;
+      MeshPublisher & operator=( const MeshPublisher & ) = delete;
+
+      /// Writer thread only: make a version of the mesh sharing the unchanged chunks of the current one and
+      /// make it current. Nothing is encoded when the revision did not change; returns the current version
+      std::shared_ptr<const MeshVersion> publish();
+
+      /// Any thread: the version published last, nullptr before the first publish
+      std::shared_ptr<const MeshVersion> current() const;
+
+   private:
+
+      const LinkedMesh & m_mesh;
+
+      unsigned int m_thread_count;
+
+      /// only accessed through std::atomic_load and std::atomic_store
+      std::shared_ptr<const MeshVersion> m_current;
+};
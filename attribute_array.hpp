@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Storage for one per-element attribute of a structure of arrays mesh.
+/// A mesh picks the storage of every attribute through its traits. Every storage class takes the same
+/// calls, so the mesh code is written once: reads go through operator[], writes through set().
+/// Storage that can not hand out a reference reads as a const value, so assigning to a read does not compile.
+template<typename T>
+class StoredAttribute
+{
+public:
+    typedef T & reference;
+    typedef const T & const_reference;
+
+    static const bool stored = true;
+
+    /// fallback is only used by OmittedAttribute, elements get their value when they are added
+    explicit StoredAttribute( const T & fallback = T() ) { ( void )fallback; }
+
+    reference operator[]( std::size_t index ) { return m_values[index]; }
+    const_reference operator[]( std::size_t index ) const { return m_values[index]; }
+
+    void set( std::size_t index, const T & value ) { m_values[index] = value; }
+
+    template<typename... Args>
+    void emplace_back( Args&& ...args ) { m_values.emplace_back( std::forward<Args>( args )... ); }
+
+    void reserve( std::size_t count ) { m_values.reserve( count ); }
+    void clear() { m_values.clear(); }
+    std::size_t size() const { return m_values.size(); }
+
+    std::size_t allocated_bytes() const { return m_values.capacity() * sizeof( T ); }
+
+private:
+    std::vector<T> m_values;
+};
+
+template<typename T>
+const bool StoredAttribute<T>::stored;
+
+/// An attribute the mesh does not keep. Every element reads the fallback and writes are dropped, so
+/// the attribute costs no memory and reading it touches none.
+template<typename T>
+class OmittedAttribute
+{
+public:
+    typedef const T const_reference;
+
+    static const bool stored = false;
+
+    explicit OmittedAttribute( const T & fallback = T() ) : m_fallback( fallback ) {}
+
+    const_reference operator[]( std::size_t ) const { return m_fallback; }
+
+    void set( std::size_t, const T & ) {}
+
+    template<typename... Args>
+    void emplace_back( Args&& ... ) {}
+
+    void reserve( std::size_t ) {}
+    void clear() {}
+
+    std::size_t allocated_bytes() const { return 0; }
+
+private:
+    T m_fallback;
+};
+
+template<typename T>
+const bool OmittedAttribute<T>::stored;
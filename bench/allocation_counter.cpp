@@ -0,0 +1,77 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> allocations( 0 );
+
+    void * allocate( std::size_t size )
+    {
+        allocations.fetch_add( 1, std::memory_order_relaxed );
+        return std::malloc( size == 0 ? 1 : size );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+uint64_t allocation_count()
+{
+    return allocations.load( std::memory_order_relaxed );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void * operator new( std::size_t size )
+{
+    if( const auto memory = allocate( size ) )
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void * operator new( std::size_t size, const std::nothrow_t & ) noexcept
+{
+    return allocate( size );
+}
+
+void * operator new[]( std::size_t size, const std::nothrow_t & ) noexcept
+{
+    return allocate( size );
+}
+
+void operator delete( void * memory ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete[]( void * memory ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete( void * memory, std::size_t ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete[]( void * memory, std::size_t ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete( void * memory, const std::nothrow_t & ) noexcept
+{
+    std::free( memory );
+}
+
+void operator delete[]( void * memory, const std::nothrow_t & ) noexcept
+{
+    std::free( memory );
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+/// Number of calls to the global operator new since the program started, from every thread.
+/// Counted by the replacement operators in allocation_counter.cpp
+uint64_t allocation_count();
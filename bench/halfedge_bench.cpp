@@ -0,0 +1,289 @@
+#include "core/mesh/LinkedMesh.hpp"
+
+#include "allocation_counter.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// Throughput of the LinkedMesh building and export paths from 1K faces up to HALFEDGE_BENCH_MAX_FACES.
+/// Every benchmark reports
+///   bytes_per_element  allocated_bytes() of the mesh divided by its vertices, halfedges and faces
+///   allocs_per_op      calls to the global operator new in the timed part, per add_face, extrusion,
+///                      bridge or exported face
+/// Run a single size with --benchmark_filter, e.g. --benchmark_filter=AddFace/1000000
+
+#ifndef HALFEDGE_BENCH_MAX_FACES
+#define HALFEDGE_BENCH_MAX_FACES 10000000
+#endif
+
+namespace
+{
+    const vec3 extrude_offset( 0.0f, 0.0f, 1.0f );
+
+    /// face counts of every benchmark, powers of ten
+    void face_counts( benchmark::internal::Benchmark * bench )
+    {
+        for( int64_t count = 1000; count <= HALFEDGE_BENCH_MAX_FACES; count *= 10 )
+        {
+            bench->Arg( count );
+        }
+        bench->Unit( benchmark::kMillisecond );
+    }
+
+    /// count unit quads in rows of a square grid, each with its own vertices
+    void add_quads( LinkedMesh & mesh, const size_t count )
+    {
+        const auto row = static_cast<size_t>( std::ceil( std::sqrt( double( count ) ) ) );
+
+        for( size_t i = 0; i < count; ++i )
+        {
+            const auto x = float( 2 * ( i % row ) );
+            const auto y = float( i / row );
+
+            mesh.add_face( vec3( x, y, 0.0f ), vec3( x + 1.0f, y, 0.0f ), vec3( x + 1.0f, y + 1.0f, 0.0f ), vec3( x, y + 1.0f, 0.0f ) );
+        }
+    }
+
+    /// live and free elements of the mesh
+    size_t element_count( const LinkedMesh & mesh )
+    {
+        return mesh.vertex_count() + mesh.edge_count() + mesh.face_count();
+    }
+
+    void report( benchmark::State & state, const LinkedMesh & mesh, const uint64_t allocations, const size_t operations )
+    {
+        const auto total_operations = double( state.iterations() ) * double( operations );
+
+        state.SetItemsProcessed( static_cast<int64_t>( total_operations ) );
+        state.counters["bytes_per_element"] = double( mesh.allocated_bytes() ) / double( element_count( mesh ) );
+        state.counters["allocs_per_op"] = double( allocations ) / total_operations;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// add_face into a cleared mesh, growing its storage from nothing
+static void AddFace( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    LinkedMesh mesh;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        state.PauseTiming();
+        mesh.clear();
+        state.ResumeTiming();
+
+        const auto before = allocation_count();
+        add_quads( mesh, count );
+        allocations += allocation_count() - before;
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( AddFace )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// reset() and add_face again, reusing the storage of the previous build
+static void ResetRebuild( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    LinkedMesh mesh;
+    add_quads( mesh, count );
+
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        const auto before = allocation_count();
+        mesh.reset();
+        add_quads( mesh, count );
+        allocations += allocation_count() - before;
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( ResetRebuild )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// extrude_face once on every quad of a grid, each extrusion adds five faces
+static void ExtrudeFace( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) ) / 6;
+
+    LinkedMesh mesh;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        state.PauseTiming();
+        mesh.clear();
+        add_quads( mesh, count );
+        state.ResumeTiming();
+
+        const auto before = allocation_count();
+
+        for( size_t i = 0; i < count; ++i )
+        {
+            mesh.extrude_face( mesh.face( i ), extrude_offset );
+        }
+        allocations += allocation_count() - before;
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( ExtrudeFace )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// extrude one face over and over, a chain of four walls per step. The cap of extrude_face is linked
+/// to its walls and can not be extruded again, so the chain goes through extrude_faces
+static void ExtrudeFaceChain( benchmark::State & state )
+{
+    const auto steps = static_cast<size_t>( state.range( 0 ) ) / 4;
+
+    LinkedMesh mesh;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        state.PauseTiming();
+        mesh.clear();
+        auto cap = mesh.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 1.0f, 1.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) );
+        state.ResumeTiming();
+
+        const auto before = allocation_count();
+
+        for( size_t i = 0; i < steps; ++i )
+        {
+            mesh.extrude_faces( &cap, 1, extrude_offset );
+        }
+        allocations += allocation_count() - before;
+    }
+
+    report( state, mesh, allocations, steps );
+}
+BENCHMARK( ExtrudeFaceChain )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// bridge_edges between the facing sides of quad pairs, each pair and its bridge are three faces
+static void BridgeEdges( benchmark::State & state )
+{
+    const auto pairs = static_cast<size_t>( state.range( 0 ) ) / 3;
+
+    LinkedMesh mesh;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        state.PauseTiming();
+        mesh.clear();
+        add_quads( mesh, 2 * pairs );
+        state.ResumeTiming();
+
+        const auto before = allocation_count();
+
+        for( size_t i = 0; i < pairs; ++i )
+        {
+            /// the right side of the first quad faces the left side of the second one
+            const auto right = mesh.face( 2 * i )->edge->next;
+            const auto left = mesh.face( 2 * i + 1 )->edge->next->next->next;
+
+            mesh.bridge_edges( right, left );
+        }
+        allocations += allocation_count() - before;
+    }
+
+    report( state, mesh, allocations, pairs );
+}
+BENCHMARK( BridgeEdges )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// triangles( vertices ) into a buffer that keeps its capacity between exports
+static void TrianglesVertices( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    LinkedMesh mesh;
+    add_quads( mesh, count );
+
+    std::vector<Mesh::Vertex> vertices;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        const auto before = allocation_count();
+        vertices.clear();
+        mesh.triangles( vertices );
+        allocations += allocation_count() - before;
+
+        benchmark::DoNotOptimize( vertices.data() );
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( TrianglesVertices )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// triangles( position_buffer, color_buffer ) into buffers that keep their capacity between exports
+static void TrianglesBuffers( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    LinkedMesh mesh;
+    add_quads( mesh, count );
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        const auto before = allocation_count();
+        positions.clear();
+        colors.clear();
+        mesh.triangles( positions, colors );
+        allocations += allocation_count() - before;
+
+        benchmark::DoNotOptimize( positions.data() );
+        benchmark::DoNotOptimize( colors.data() );
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( TrianglesBuffers )->Apply( face_counts );
+
+/// ////////////////////////////////////////////////////////////////////////////
+/// points() into buffers that keep their capacity between exports
+static void Points( benchmark::State & state )
+{
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    LinkedMesh mesh;
+    add_quads( mesh, count );
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    uint64_t allocations = 0;
+
+    for( auto _ : state )
+    {
+        const auto before = allocation_count();
+        positions.clear();
+        colors.clear();
+        mesh.points( positions, colors );
+        allocations += allocation_count() - before;
+
+        benchmark::DoNotOptimize( positions.data() );
+        benchmark::DoNotOptimize( colors.data() );
+    }
+
+    report( state, mesh, allocations, count );
+}
+BENCHMARK( Points )->Apply( face_counts );
+
+BENCHMARK_MAIN();
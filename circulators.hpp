@@ -0,0 +1,157 @@
+#pragma once
+
+/// Allocation free ranges over the neighbourhood of mesh elements, usable in range-for.
+/// They hold handles only, so they stay valid as long as the topology is not edited.
+
+/// the edge before edge in its face loop
+inline EdgeHandle previous_edge( const EdgeHandle edge )
+{
+	auto previous = edge;
+
+	while( previous->next != edge )
+	{
+		previous = previous->next;
+	}
+
+	return previous;
+}
+
+/// halfedges of a face loop, starting at face->edge
+class FaceEdges
+{
+public:
+
+	class iterator
+	{
+	public:
+		iterator( EdgeHandle edge, EdgeHandle first ) : m_edge( edge ), m_first( first ) {}
+
+		EdgeHandle operator*() const { return m_edge; }
+
+		iterator & operator++()
+		{
+			m_edge = m_edge->next == m_first ? nullptr : m_edge->next;
+			return *this;
+		}
+
+		bool operator==( const iterator & other ) const { return m_edge == other.m_edge; }
+		bool operator!=( const iterator & other ) const { return m_edge != other.m_edge; }
+
+	private:
+		EdgeHandle m_edge;
+		EdgeHandle m_first;
+	};
+
+	explicit FaceEdges( FaceHandle face ) : m_first( face->edge ) {}
+
+	iterator begin() const { return iterator( m_first, m_first ); }
+	iterator end() const { return iterator( nullptr, m_first ); }
+
+private:
+	EdgeHandle m_first;
+};
+
+/// faces sharing an edge with a face, edges without opposing halfedge are skipped
+class FaceNeighbours
+{
+public:
+
+	class iterator
+	{
+	public:
+		iterator( FaceEdges::iterator edge, FaceEdges::iterator end ) : m_edge( edge ), m_end( end ) { skip_open_edges(); }
+
+		FaceHandle operator*() const { return ( *m_edge )->opposing->face; }
+
+		iterator & operator++()
+		{
+			++m_edge;
+			skip_open_edges();
+			return *this;
+		}
+
+		bool operator==( const iterator & other ) const { return m_edge == other.m_edge; }
+		bool operator!=( const iterator & other ) const { return m_edge != other.m_edge; }
+
+	private:
+		void skip_open_edges()
+		{
+			while( m_edge != m_end && ( ( *m_edge )->opposing == nullptr || ( *m_edge )->opposing->face == nullptr ) )
+			{
+				++m_edge;
+			}
+		}
+
+		FaceEdges::iterator m_edge;
+		FaceEdges::iterator m_end;
+	};
+
+	explicit FaceNeighbours( FaceHandle face ) : m_edges( face ) {}
+
+	iterator begin() const { return iterator( m_edges.begin(), m_edges.end() ); }
+	iterator end() const { return iterator( m_edges.end(), m_edges.end() ); }
+
+private:
+	FaceEdges m_edges;
+};
+
+/// halfedges leaving a vertex, each one leads to a neighbour ( edge->next->vertex ) and a face ( edge->face ).
+/// Turns across opposing halfedges starting at vertex->edge; when it runs into the mesh boundary
+/// it continues from vertex->edge in the other direction, so open fans are covered completely.
+class VertexOneRing
+{
+public:
+
+	class iterator
+	{
+	public:
+		iterator( EdgeHandle start ) : m_start( start ), m_edge( start ), m_backward( false ) {}
+
+		EdgeHandle operator*() const { return m_edge; }
+
+		iterator & operator++()
+		{
+			if( !m_backward )
+			{
+				const auto opposing = m_edge->opposing;
+				const auto next = opposing ? opposing->next : nullptr;
+
+				if( next == m_start )
+				{
+					/// closed fan, back at the start
+					m_edge = nullptr;
+					return *this;
+				}
+
+				if( next != nullptr )
+				{
+					m_edge = next;
+					return *this;
+				}
+
+				/// reached the boundary, turn the other way around from the start
+				m_backward = true;
+				m_edge = m_start;
+			}
+
+			m_edge = previous_edge( m_edge )->opposing;
+			return *this;
+		}
+
+		bool operator==( const iterator & other ) const { return m_edge == other.m_edge; }
+		bool operator!=( const iterator & other ) const { return m_edge != other.m_edge; }
+
+	private:
+		EdgeHandle m_start;
+		EdgeHandle m_edge;
+		bool m_backward;
+	};
+
+	explicit VertexOneRing( VertexHandle vertex ) : m_start( vertex->edge ) {}
+
+	iterator begin() const { return iterator( m_start ); }
+	iterator end() const { return iterator( nullptr ); }
+
+private:
+	EdgeHandle m_start;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+/// Declarations the mesh sources take from the engine they are part of, for building them on their own.
+/// The engine build force-includes its own prelude instead, see HALFEDGE_PRELUDE in CMakeLists.txt
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+using namespace glm;
+
+typedef unsigned int uint;
+
+struct Vertex;
+struct Edge;
+struct Face;
+
+typedef Vertex* VertexHandle;
+typedef Edge* EdgeHandle;
+typedef Face* FaceHandle;
+
+/// vertex layout of the render buffers filled by triangles()
+struct Mesh
+{
+    struct Vertex
+    {
+        Vertex() : light( 0.0f ) {}
+
+        Vertex( const vec4 & position, const vec4 & color, const vec3 & normal, const vec2 & texcoord, const vec3 & barycenter, const float light ) :
+            position( position ),
+            color( color ),
+            normal( normal ),
+            texcoord( texcoord ),
+            barycenter( barycenter ),
+            light( light )
+        {
+        }
+
+        vec4 position;
+        vec4 color;
+        vec3 normal;
+        vec2 texcoord;
+        vec3 barycenter;
+        float light;
+    };
+};
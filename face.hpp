@@ -14,4 +14,5 @@ struct Face
 	vec3 normal;
 	vec4 color;
 	bool initialized = false;
+	bool dirty = false;
 };
\ No newline at end of file
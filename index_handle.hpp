@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+/// 32 bit index into one of the element arrays of a mesh.
+/// The tag keeps vertex, edge and face handles from being mixed up.
+template<typename Tag>
+struct IndexHandle
+{
+	static const uint32_t invalid_index = 0xFFFFFFFFu;
+
+	IndexHandle() : index( invalid_index )
+	{
+
+	};
+
+	explicit IndexHandle( uint32_t index ) : index( index )
+	{
+
+	};
+
+	bool valid() const { return index != invalid_index; }
+
+	explicit operator bool() const { return valid(); }
+
+	bool operator==( const IndexHandle & other ) const { return index == other.index; }
+
+	bool operator!=( const IndexHandle & other ) const { return index != other.index; }
+
+	uint32_t index;
+};
+
+template<typename Tag>
+const uint32_t IndexHandle<Tag>::invalid_index;
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Binary min heap over the items 0 .. capacity-1, keyed by a float cost.
+/// Every item knows its place in the heap, so the cost of an item can be changed or the item removed
+/// in O(log n). After reserve() no operation allocates.
+class IndexedHeap
+{
+public:
+
+    IndexedHeap() {}
+
+    /// make room for items 0 .. capacity-1 and empty the heap
+    void reserve( std::size_t capacity )
+    {
+        m_heap.clear();
+        m_heap.reserve( capacity );
+        m_position.assign( capacity, uint32_t( absent ) );
+        m_cost.assign( capacity, 0.0f );
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    std::size_t size() const { return m_heap.size(); }
+
+    bool contains( uint32_t item ) const { return item < m_position.size() && m_position[item] != absent; }
+
+    /// item with the lowest cost and its cost
+    uint32_t top() const { assert( !empty() ); return m_heap.front(); }
+    float top_cost() const { assert( !empty() ); return m_cost[m_heap.front()]; }
+
+    float cost( uint32_t item ) const { return m_cost[item]; }
+
+    /// insert item, or change its cost if it is in the heap already
+    void update( uint32_t item, float cost )
+    {
+        assert( item < m_position.size() );
+
+        if( m_position[item] == absent )
+        {
+            m_cost[item] = cost;
+            m_position[item] = static_cast<uint32_t>( m_heap.size() );
+            m_heap.push_back( item );
+            sift_up( m_position[item] );
+            return;
+        }
+
+        const float previous = m_cost[item];
+        m_cost[item] = cost;
+
+        if( cost < previous )
+        {
+            sift_up( m_position[item] );
+        }
+        else
+        {
+            sift_down( m_position[item] );
+        }
+    }
+
+    /// remove item if it is in the heap
+    void remove( uint32_t item )
+    {
+        if( !contains( item ) )
+        {
+            return;
+        }
+
+        const uint32_t position = m_position[item];
+        const uint32_t last = m_heap.back();
+        m_heap.pop_back();
+        m_position[item] = absent;
+
+        if( last != item )
+        {
+            m_heap[position] = last;
+            m_position[last] = position;
+            sift_up( position );
+            sift_down( m_position[last] );
+        }
+    }
+
+    /// remove and return the item with the lowest cost
+    uint32_t pop()
+    {
+        const uint32_t item = top();
+        remove( item );
+        return item;
+    }
+
+private:
+
+    static const uint32_t absent = 0xFFFFFFFFu;
+
+    void sift_up( uint32_t position )
+    {
+        const uint32_t item = m_heap[position];
+
+        while( position > 0 )
+        {
+            const uint32_t parent = ( position - 1 ) / 2;
+
+            if( !( m_cost[item] < m_cost[m_heap[parent]] ) )
+            {
+                break;
+            }
+
+            place( m_heap[parent], position );
+            position = parent;
+        }
+
+        place( item, position );
+    }
+
+    void sift_down( uint32_t position )
+    {
+        const uint32_t item = m_heap[position];
+        const uint32_t count = static_cast<uint32_t>( m_heap.size() );
+
+        while( true )
+        {
+            uint32_t child = position * 2 + 1;
+
+            if( child >= count )
+            {
+                break;
+            }
+
+            if( child + 1 < count && m_cost[m_heap[child + 1]] < m_cost[m_heap[child]] )
+            {
+                ++child;
+            }
+
+            if( !( m_cost[m_heap[child]] < m_cost[item] ) )
+            {
+                break;
+            }
+
+            place( m_heap[child], position );
+            position = child;
+        }
+
+        place( item, position );
+    }
+
+    void place( uint32_t item, uint32_t position )
+    {
+        m_heap[position] = item;
+        m_position[item] = position;
+    }
+
+    /// items in heap order
+    std::vector<uint32_t> m_heap;
+
+    /// place of every item in m_heap, absent when it is not in the heap
+    std::vector<uint32_t> m_position;
+
+    /// cost of every item
+    std::vector<float> m_cost;
+};
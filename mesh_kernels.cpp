@@ -0,0 +1,169 @@
+#include "core/mesh/mesh_kernels.hpp"
+
+#include <cmath>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /// scalar fallback, also handles the tail of the vector loops
+    void triangle_normals_scalar( const mesh_kernels::TriangleCorners & p, float * nx, float * ny, float * nz, size_t begin, const size_t end )
+    {
+        for( ; begin < end; ++begin )
+        {
+            const float ax = p.x[0][begin] - p.x[1][begin];
+            const float ay = p.y[0][begin] - p.y[1][begin];
+            const float az = p.z[0][begin] - p.z[1][begin];
+            const float bx = p.x[0][begin] - p.x[2][begin];
+            const float by = p.y[0][begin] - p.y[2][begin];
+            const float bz = p.z[0][begin] - p.z[2][begin];
+
+            const float cx = ay * bz - az * by;
+            const float cy = az * bx - ax * bz;
+            const float cz = ax * by - ay * bx;
+
+            const float inverse_length = 1.0f / std::sqrt( cx * cx + cy * cy + cz * cz );
+
+            nx[begin] = cx * inverse_length;
+            ny[begin] = cy * inverse_length;
+            nz[begin] = cz * inverse_length;
+        }
+    }
+
+    /// triangle constants shared by every point in barycentric_coordinates
+    struct BarycentricFrame
+    {
+        vec3 a, v0, v1;
+        float d00, d01, d11, denom;
+    };
+
+    void barycentric_coordinates_scalar( const BarycentricFrame & f, const float * px, const float * py, const float * pz,
+                                         float * u, float * v, float * w, size_t begin, const size_t end )
+    {
+        for( ; begin < end; ++begin )
+        {
+            const float v2x = px[begin] - f.a[0];
+            const float v2y = py[begin] - f.a[1];
+            const float v2z = pz[begin] - f.a[2];
+
+            const float d20 = v2x * f.v0[0] + v2y * f.v0[1] + v2z * f.v0[2];
+            const float d21 = v2x * f.v1[0] + v2y * f.v1[1] + v2z * f.v1[2];
+
+            v[begin] = ( f.d11 * d20 - f.d01 * d21 ) / f.denom;
+            w[begin] = ( f.d00 * d21 - f.d01 * d20 ) / f.denom;
+            u[begin] = 1.0f - v[begin] - w[begin];
+        }
+    }
+
+#if defined( __AVX__ )
+    typedef __m256 simd_float;
+    const size_t simd_width = 8;
+    inline simd_float simd_load( const float * p ) { return _mm256_loadu_ps( p ); }
+    inline void simd_store( float * p, simd_float a ) { _mm256_storeu_ps( p, a ); }
+    inline simd_float simd_set( float a ) { return _mm256_set1_ps( a ); }
+    inline simd_float simd_add( simd_float a, simd_float b ) { return _mm256_add_ps( a, b ); }
+    inline simd_float simd_sub( simd_float a, simd_float b ) { return _mm256_sub_ps( a, b ); }
+    inline simd_float simd_mul( simd_float a, simd_float b ) { return _mm256_mul_ps( a, b ); }
+    inline simd_float simd_div( simd_float a, simd_float b ) { return _mm256_div_ps( a, b ); }
+    inline simd_float simd_sqrt( simd_float a ) { return _mm256_sqrt_ps( a ); }
+#define MESH_KERNELS_SIMD 1
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+    typedef __m128 simd_float;
+    const size_t simd_width = 4;
+    inline simd_float simd_load( const float * p ) { return _mm_loadu_ps( p ); }
+    inline void simd_store( float * p, simd_float a ) { _mm_storeu_ps( p, a ); }
+    inline simd_float simd_set( float a ) { return _mm_set1_ps( a ); }
+    inline simd_float simd_add( simd_float a, simd_float b ) { return _mm_add_ps( a, b ); }
+    inline simd_float simd_sub( simd_float a, simd_float b ) { return _mm_sub_ps( a, b ); }
+    inline simd_float simd_mul( simd_float a, simd_float b ) { return _mm_mul_ps( a, b ); }
+    inline simd_float simd_div( simd_float a, simd_float b ) { return _mm_div_ps( a, b ); }
+    inline simd_float simd_sqrt( simd_float a ) { return _mm_sqrt_ps( a ); }
+#define MESH_KERNELS_SIMD 1
+#endif
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void mesh_kernels::triangle_normals( const TriangleCorners & p, float * nx, float * ny, float * nz, const size_t count )
+{
+    size_t i = 0;
+
+#if defined( MESH_KERNELS_SIMD )
+    const simd_float one = simd_set( 1.0f );
+
+    for( ; i + simd_width <= count; i += simd_width )
+    {
+        const simd_float x0 = simd_load( p.x[0] + i );
+        const simd_float y0 = simd_load( p.y[0] + i );
+        const simd_float z0 = simd_load( p.z[0] + i );
+
+        const simd_float ax = simd_sub( x0, simd_load( p.x[1] + i ) );
+        const simd_float ay = simd_sub( y0, simd_load( p.y[1] + i ) );
+        const simd_float az = simd_sub( z0, simd_load( p.z[1] + i ) );
+        const simd_float bx = simd_sub( x0, simd_load( p.x[2] + i ) );
+        const simd_float by = simd_sub( y0, simd_load( p.y[2] + i ) );
+        const simd_float bz = simd_sub( z0, simd_load( p.z[2] + i ) );
+
+        const simd_float cx = simd_sub( simd_mul( ay, bz ), simd_mul( az, by ) );
+        const simd_float cy = simd_sub( simd_mul( az, bx ), simd_mul( ax, bz ) );
+        const simd_float cz = simd_sub( simd_mul( ax, by ), simd_mul( ay, bx ) );
+
+        const simd_float length_squared = simd_add( simd_add( simd_mul( cx, cx ), simd_mul( cy, cy ) ), simd_mul( cz, cz ) );
+        const simd_float inverse_length = simd_div( one, simd_sqrt( length_squared ) );
+
+        simd_store( nx + i, simd_mul( cx, inverse_length ) );
+        simd_store( ny + i, simd_mul( cy, inverse_length ) );
+        simd_store( nz + i, simd_mul( cz, inverse_length ) );
+    }
+#endif
+
+    triangle_normals_scalar( p, nx, ny, nz, i, count );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+void mesh_kernels::barycentric_coordinates( const float * px, const float * py, const float * pz, const size_t count,
+                                            const vec3 & a, const vec3 & b, const vec3 & c,
+                                            float * u, float * v, float * w )
+{
+    BarycentricFrame f;
+    f.a = a;
+    f.v0 = b - a;
+    f.v1 = c - a;
+    f.d00 = glm::dot( f.v0, f.v0 );
+    f.d01 = glm::dot( f.v0, f.v1 );
+    f.d11 = glm::dot( f.v1, f.v1 );
+    f.denom = f.d00 * f.d11 - f.d01 * f.d01;
+
+    size_t i = 0;
+
+#if defined( MESH_KERNELS_SIMD )
+    const simd_float ax = simd_set( a[0] ), ay = simd_set( a[1] ), az = simd_set( a[2] );
+    const simd_float v0x = simd_set( f.v0[0] ), v0y = simd_set( f.v0[1] ), v0z = simd_set( f.v0[2] );
+    const simd_float v1x = simd_set( f.v1[0] ), v1y = simd_set( f.v1[1] ), v1z = simd_set( f.v1[2] );
+    const simd_float d00 = simd_set( f.d00 ), d01 = simd_set( f.d01 ), d11 = simd_set( f.d11 );
+    const simd_float denom = simd_set( f.denom );
+    const simd_float one = simd_set( 1.0f );
+
+    for( ; i + simd_width <= count; i += simd_width )
+    {
+        const simd_float v2x = simd_sub( simd_load( px + i ), ax );
+        const simd_float v2y = simd_sub( simd_load( py + i ), ay );
+        const simd_float v2z = simd_sub( simd_load( pz + i ), az );
+
+        const simd_float d20 = simd_add( simd_add( simd_mul( v2x, v0x ), simd_mul( v2y, v0y ) ), simd_mul( v2z, v0z ) );
+        const simd_float d21 = simd_add( simd_add( simd_mul( v2x, v1x ), simd_mul( v2y, v1y ) ), simd_mul( v2z, v1z ) );
+
+        const simd_float vv = simd_div( simd_sub( simd_mul( d11, d20 ), simd_mul( d01, d21 ) ), denom );
+        const simd_float ww = simd_div( simd_sub( simd_mul( d00, d21 ), simd_mul( d01, d20 ) ), denom );
+
+        simd_store( v + i, vv );
+        simd_store( w + i, ww );
+        simd_store( u + i, simd_sub( simd_sub( one, vv ), ww ) );
+    }
+#endif
+
+    barycentric_coordinates_scalar( f, px, py, pz, u, v, w, i, count );
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+/// Batch geometry kernels over structure of arrays data.
+/// They use AVX or SSE2 when the compiler targets it and a scalar loop otherwise.
+/// Every path evaluates the same IEEE operations in the same order as
+/// LinkedMesh::compute_normal and LinkedMesh::compute_barycenter.
+namespace mesh_kernels
+{
+    /// SoA coordinates of triangle corners
+    struct TriangleCorners
+    {
+        const float * x[3];
+        const float * y[3];
+        const float * z[3];
+    };
+
+    /// unit normals of count triangles, normalize( cross( p0 - p1, p0 - p2 ) )
+    void triangle_normals( const TriangleCorners & corners, float * nx, float * ny, float * nz, const size_t count );
+
+    /// barycentric coordinates of count points in the triangle a b c
+    void barycentric_coordinates( const float * px, const float * py, const float * pz, const size_t count,
+                                  const vec3 & a, const vec3 & b, const vec3 & c,
+                                  float * u, float * v, float * w );
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+/// Binary layout of a LinkedMesh snapshot.
+/// A snapshot is the header followed by the vertex, edge and face records and the three free lists,
+/// each array starting on an 8 byte boundary. Links are stored as element indices, invalid_index
+/// stands for a nullptr. All values are little endian, as written by the machine that saved them.
+namespace mesh_snapshot
+{
+	const uint32_t magic = 0x534D4548u; // "HEMS"
+	const uint32_t version = 1;
+	const uint32_t invalid_index = 0xFFFFFFFFu;
+
+	/// set in the flags of elements that are part of the mesh, clear for elements on a free list
+	const uint32_t flag_initialized = 1u;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+
+		/// record sizes, a snapshot from an incompatible build is rejected
+		uint32_t vertex_record_size;
+		uint32_t edge_record_size;
+		uint32_t face_record_size;
+		uint32_t reserved;
+
+		uint64_t vertex_count;
+		uint64_t edge_count;
+		uint64_t face_count;
+		uint64_t free_vertex_count;
+		uint64_t free_edge_count;
+		uint64_t free_face_count;
+	};
+
+	struct VertexRecord
+	{
+		float position[3];
+		float color[4];
+		float light;
+		uint32_t edge;
+		uint32_t flags;
+	};
+
+	struct EdgeRecord
+	{
+		uint32_t vertex;
+		uint32_t next;
+		uint32_t opposing;
+		uint32_t face;
+		float texcoord[2];
+		float barycenter[3];
+		uint32_t flags;
+	};
+
+	struct FaceRecord
+	{
+		uint32_t edge;
+		float normal[3];
+		float color[4];
+		uint32_t flags;
+		uint32_t reserved;
+	};
+
+	/// bytes from the start of an array of size bytes to the start of the next one
+	inline uint64_t aligned_size( const uint64_t size )
+	{
+		return ( size + 7 ) & ~uint64_t( 7 );
+	}
+}
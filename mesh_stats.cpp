@@ -0,0 +1,60 @@
+#include "core/mesh/mesh_stats.hpp"
+
+#include <sstream>
+
+namespace
+{
+    void write( std::ostringstream & json, const char * name, const MeshStats::FreeListCounter & counter )
+    {
+        json << "\"" << name << "\":{\"hits\":" << counter.hits << ",\"misses\":" << counter.misses
+             << ",\"hit_rate\":" << counter.hit_rate() << "}";
+    }
+
+    void write( std::ostringstream & json, const char * name, const MeshStats::Timer & timer )
+    {
+        json << "\"" << name << "\":{\"calls\":" << timer.calls << ",\"total_seconds\":" << timer.total_seconds
+             << ",\"max_seconds\":" << timer.max_seconds << "}";
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+std::string MeshStats::to_json() const
+{
+    std::ostringstream json;
+
+    json << "{\"collecting\":" << ( collecting ? "true" : "false" )
+         << ",\"live\":{\"vertices\":" << live_vertices << ",\"edges\":" << live_edges << ",\"faces\":" << live_faces << "}"
+         << ",\"free\":{\"vertices\":" << free_vertices << ",\"edges\":" << free_edges << ",\"faces\":" << free_faces << "}"
+         << ",\"unreferenced_vertices\":" << unreferenced_vertices
+         << ",\"allocated_bytes\":" << allocated_bytes;
+
+    json << ",\"free_lists\":{";
+    write( json, "vertices", counters.vertices );
+    json << ",";
+    write( json, "edges", counters.edges );
+    json << ",";
+    write( json, "faces", counters.faces );
+    json << "}";
+
+    json << ",\"timings\":{";
+    write( json, "triangles", counters.triangles );
+    json << ",";
+    write( json, "triangles_parallel", counters.triangles_parallel );
+    json << ",";
+    write( json, "triangles_indexed", counters.triangles_indexed );
+    json << ",";
+    write( json, "triangles_incremental", counters.triangles_incremental );
+    json << ",";
+    write( json, "points", counters.points );
+    json << ",";
+    write( json, "extrude_vertex", counters.extrude_vertex );
+    json << ",";
+    write( json, "extrude_edge", counters.extrude_edge );
+    json << ",";
+    write( json, "extrude_face", counters.extrude_face );
+    json << ",";
+    write( json, "extrude_faces", counters.extrude_faces );
+    json << "}}";
+
+    return json.str();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Instrumentation of a LinkedMesh.
+/// Element counts and memory are computed when the stats are queried and are always available.
+/// Free list hit rates and call timings are only collected when the library is built with
+/// LINKEDMESH_STATS defined, otherwise the instrumentation points compile to nothing and the
+/// counters stay zero. Collection is not synchronized, do not edit or export one mesh from
+/// several threads at once while it is enabled.
+struct MeshStats
+{
+    /// allocations served from a free list ( hits ) or by growing the storage ( misses )
+    struct FreeListCounter
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        double hit_rate() const { return hits + misses > 0 ? double( hits ) / double( hits + misses ) : 0.0; }
+    };
+
+    /// wall clock time spent in one operation
+    struct Timer
+    {
+        uint64_t calls = 0;
+        double total_seconds = 0.0;
+        double max_seconds = 0.0;
+
+        void add( const double seconds )
+        {
+            ++calls;
+            total_seconds += seconds;
+            max_seconds = seconds > max_seconds ? seconds : max_seconds;
+        }
+    };
+
+    /// adds the lifetime of the scope to a timer
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer( Timer & timer ) : m_timer( timer ), m_start( std::chrono::steady_clock::now() ) {}
+
+        ~ScopedTimer()
+        {
+            m_timer.add( std::chrono::duration<double>( std::chrono::steady_clock::now() - m_start ).count() );
+        }
+
+        ScopedTimer( const ScopedTimer & ) = delete;
+        ScopedTimer & operator=( const ScopedTimer & ) = delete;
+
+    private:
+        Timer & m_timer;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /// counters collected while the mesh is used, cleared by LinkedMesh::reset_stats
+    struct Counters
+    {
+        FreeListCounter vertices;
+        FreeListCounter edges;
+        FreeListCounter faces;
+
+        Timer triangles;
+        Timer triangles_parallel;
+        Timer triangles_indexed;
+        Timer triangles_incremental;
+        Timer points;
+
+        Timer extrude_vertex;
+        Timer extrude_edge;
+        Timer extrude_face;
+        Timer extrude_faces;
+    };
+
+    /// elements in the mesh and on the free lists
+    size_t live_vertices = 0;
+    size_t live_edges = 0;
+    size_t live_faces = 0;
+    size_t free_vertices = 0;
+    size_t free_edges = 0;
+    size_t free_faces = 0;
+
+    /// live vertices no halfedge starts from, a growing number points at leaked vertices
+    size_t unreferenced_vertices = 0;
+
+    /// heap memory held by the mesh, see LinkedMesh::allocated_bytes
+    size_t allocated_bytes = 0;
+
+    /// true when the library was built with LINKEDMESH_STATS
+    bool collecting = false;
+
+    Counters counters;
+
+    /// the stats as one JSON object
+    std::string to_json() const;
+};
+
+#if defined( LINKEDMESH_STATS )
+#define LINKEDMESH_STATS_HIT( counter ) ++( counter ).hits
+#define LINKEDMESH_STATS_MISS( counter ) ++( counter ).misses
+#define LINKEDMESH_STATS_TIME( timer ) const MeshStats::ScopedTimer mesh_stats_timer( timer )
+#else
+#define LINKEDMESH_STATS_HIT( counter ) ( (void)0 )
+#define LINKEDMESH_STATS_MISS( counter ) ( (void)0 )
+#define LINKEDMESH_STATS_TIME( timer ) ( (void)0 )
+#endif
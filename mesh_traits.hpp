@@ -0,0 +1,48 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "attribute_array.hpp"
+#include "quantized_attribute.hpp"
+
+/// Attribute sets for BasicCompactLinkedMesh.
+/// A traits type names the storage of every attribute: StoredAttribute keeps a value per element,
+/// OmittedAttribute keeps none and reads a constant, the classes of quantized_attribute.hpp keep a
+/// compressed value. Positions can be compressed but not omitted, connectivity is always stored.
+/// Export still writes complete Mesh::Vertex records, omitted attributes take the fallback the mesh
+/// constructor gives them.
+
+/// every attribute, as used for rendering
+struct RenderMeshTraits
+{
+    typedef StoredAttribute<vec3> VertexPosition;
+    typedef StoredAttribute<vec4> VertexColor;
+    typedef StoredAttribute<float> VertexLight;
+    typedef StoredAttribute<vec2> EdgeTexcoord;
+    typedef StoredAttribute<vec3> FaceNormal;
+    typedef StoredAttribute<vec4> FaceColor;
+};
+
+/// topology and positions only, for meshes that are queried but never drawn
+struct CollisionMeshTraits
+{
+    typedef StoredAttribute<vec3> VertexPosition;
+    typedef OmittedAttribute<vec4> VertexColor;
+    typedef OmittedAttribute<float> VertexLight;
+    typedef OmittedAttribute<vec2> EdgeTexcoord;
+    typedef OmittedAttribute<vec3> FaceNormal;
+    typedef OmittedAttribute<vec4> FaceColor;
+};
+
+/// every attribute, colors as RGBA8, texcoords as 16 bit unorm and positions quantized to
+/// PositionBits per axis on a grid over the mesh bounds, or over those given by BasicCompactLinkedMesh::set_bounds
+template<unsigned int PositionBits>
+struct QuantizedMeshTraits
+{
+    typedef QuantizedPositions<PositionBits> VertexPosition;
+    typedef Rgba8Attribute VertexColor;
+    typedef StoredAttribute<float> VertexLight;
+    typedef Unorm16Attribute EdgeTexcoord;
+    typedef StoredAttribute<vec3> FaceNormal;
+    typedef Rgba8Attribute FaceColor;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// Threads to use for count items when thread_count were requested (0 = one per hardware thread),
+/// keeping at least min_items_per_thread items on every thread
+inline unsigned int parallel_thread_count( const std::size_t count, unsigned int thread_count, const std::size_t min_items_per_thread )
+{
+    if( thread_count == 0 )
+    {
+        thread_count = std::max( 1u, std::thread::hardware_concurrency() );
+    }
+
+    const std::size_t useful = std::max<std::size_t>( 1, count / std::max<std::size_t>( 1, min_items_per_thread ) );
+    return static_cast<unsigned int>( std::min<std::size_t>( thread_count, useful ) );
+}
+
+/// Split [0, count) into block_count contiguous blocks and call function( block, begin, end ) for each,
+/// every block on its own thread. The split only depends on count and block_count, so results written
+/// per block are deterministic. The calling thread runs the first block.
+template<typename Function>
+void parallel_for_blocks( const std::size_t count, const unsigned int block_count, Function function )
+{
+    auto block_begin = [&]( const std::size_t block )
+    {
+        return count * block / block_count;
+    };
+
+    if( block_count <= 1 )
+    {
+        function( 0u, std::size_t( 0 ), count );
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve( block_count - 1 );
+
+    for( unsigned int block = 1; block < block_count; ++block )
+    {
+        threads.emplace_back( function, block, block_begin( block ), block_begin( block + 1 ) );
+    }
+
+    function( 0u, std::size_t( 0 ), block_begin( 1 ) );
+
+    for( auto & thread : threads )
+    {
+        thread.join();
+    }
+}
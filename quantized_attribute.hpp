@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define QUANTIZED_ATTRIBUTE_SSE2 1
+#endif
+
+/// Compressed attribute storage for BasicCompactLinkedMesh, taking the same calls as StoredAttribute.
+/// Values are encoded by set() and emplace_back() and decoded by operator[], which returns by value.
+/// Decoding unpacks with SSE2 when the compiler targets it, so it stays cheap enough for triangles().
+namespace quantized
+{
+    inline uint32_t quantize( const float value, const float scale, const uint32_t max )
+    {
+        const auto scaled = value * scale + 0.5f;
+        /// NaN fails both comparisons and lands on 0
+        return !( scaled > 0.0f ) ? 0u : scaled >= float( max ) ? max : static_cast<uint32_t>( scaled );
+    }
+
+    /// four [0,1] channels as 8 bit unorm, red in the lowest byte
+    inline uint32_t encode_rgba8( const vec4 & color )
+    {
+        return quantize( color[0], 255.0f, 255 ) | quantize( color[1], 255.0f, 255 ) << 8 |
+               quantize( color[2], 255.0f, 255 ) << 16 | quantize( color[3], 255.0f, 255 ) << 24;
+    }
+
+    inline vec4 decode_rgba8( const uint32_t packed )
+    {
+        vec4 color;
+#if defined( QUANTIZED_ATTRIBUTE_SSE2 )
+        const auto zero = _mm_setzero_si128();
+        const auto bytes = _mm_cvtsi32_si128( static_cast<int>( packed ) );
+        const auto words = _mm_unpacklo_epi8( bytes, zero );
+        const auto channels = _mm_cvtepi32_ps( _mm_unpacklo_epi16( words, zero ) );
+        _mm_storeu_ps( &color[0], _mm_mul_ps( channels, _mm_set1_ps( 1.0f / 255.0f ) ) );
+#else
+        for( int i = 0; i < 4; ++i )
+        {
+            color[i] = float( ( packed >> ( i * 8 ) ) & 0xFFu ) * ( 1.0f / 255.0f );
+        }
+#endif
+        return color;
+    }
+
+    /// two [0,1] coordinates as 16 bit unorm, x in the low half
+    inline uint32_t encode_unorm16( const vec2 & texcoord )
+    {
+        return quantize( texcoord[0], 65535.0f, 65535 ) | quantize( texcoord[1], 65535.0f, 65535 ) << 16;
+    }
+
+    inline vec2 decode_unorm16( const uint32_t packed )
+    {
+        vec2 texcoord;
+#if defined( QUANTIZED_ATTRIBUTE_SSE2 )
+        const auto words = _mm_cvtsi32_si128( static_cast<int>( packed ) );
+        const auto coordinates = _mm_cvtepi32_ps( _mm_unpacklo_epi16( words, _mm_setzero_si128() ) );
+        _mm_storel_pi( reinterpret_cast<__m64 *>( &texcoord[0] ), _mm_mul_ps( coordinates, _mm_set1_ps( 1.0f / 65535.0f ) ) );
+#else
+        texcoord[0] = float( packed & 0xFFFFu ) * ( 1.0f / 65535.0f );
+        texcoord[1] = float( packed >> 16 ) * ( 1.0f / 65535.0f );
+#endif
+        return texcoord;
+    }
+
+    /// 16 bits per axis in 6 bytes
+    struct Position16
+    {
+        uint16_t axis[3];
+    };
+
+    inline void pack( Position16 & word, const uint32_t x, const uint32_t y, const uint32_t z )
+    {
+        word.axis[0] = static_cast<uint16_t>( x );
+        word.axis[1] = static_cast<uint16_t>( y );
+        word.axis[2] = static_cast<uint16_t>( z );
+    }
+
+    inline void unpack( const Position16 & word, uint32_t & x, uint32_t & y, uint32_t & z )
+    {
+        x = word.axis[0];
+        y = word.axis[1];
+        z = word.axis[2];
+    }
+
+    /// 21 bits per axis in 8 bytes, x in the lowest bits
+    inline void pack( uint64_t & word, const uint32_t x, const uint32_t y, const uint32_t z )
+    {
+        word = uint64_t( x ) | uint64_t( y ) << 21 | uint64_t( z ) << 42;
+    }
+
+    inline void unpack( const uint64_t word, uint32_t & x, uint32_t & y, uint32_t & z )
+    {
+        x = static_cast<uint32_t>( word & 0x1FFFFFu );
+        y = static_cast<uint32_t>( ( word >> 21 ) & 0x1FFFFFu );
+        z = static_cast<uint32_t>( word >> 42 );
+    }
+}
+
+/// Colors as RGBA8, channels are clamped to [0,1]
+class Rgba8Attribute
+{
+public:
+    typedef const vec4 const_reference;
+
+    static const bool stored = true;
+
+    explicit Rgba8Attribute( const vec4 & fallback = vec4() ) { ( void )fallback; }
+
+    const_reference operator[]( std::size_t index ) const { return quantized::decode_rgba8( m_values[index] ); }
+
+    void set( std::size_t index, const vec4 & value ) { m_values[index] = quantized::encode_rgba8( value ); }
+
+    template<typename... Args>
+    void emplace_back( Args&& ...args ) { m_values.push_back( quantized::encode_rgba8( vec4( std::forward<Args>( args )... ) ) ); }
+
+    void reserve( std::size_t count ) { m_values.reserve( count ); }
+    void clear() { m_values.clear(); }
+    std::size_t size() const { return m_values.size(); }
+
+    std::size_t allocated_bytes() const { return m_values.capacity() * sizeof( uint32_t ); }
+
+private:
+    std::vector<uint32_t> m_values;
+};
+
+/// Texture coordinates as 16 bit unorm, coordinates are clamped to [0,1] so wrapping coordinates need
+/// StoredAttribute<vec2>
+class Unorm16Attribute
+{
+public:
+    typedef const vec2 const_reference;
+
+    static const bool stored = true;
+
+    explicit Unorm16Attribute( const vec2 & fallback = vec2() ) { ( void )fallback; }
+
+    const_reference operator[]( std::size_t index ) const { return quantized::decode_unorm16( m_values[index] ); }
+
+    void set( std::size_t index, const vec2 & value ) { m_values[index] = quantized::encode_unorm16( value ); }
+
+    template<typename... Args>
+    void emplace_back( Args&& ...args ) { m_values.push_back( quantized::encode_unorm16( vec2( std::forward<Args>( args )... ) ) ); }
+
+    void reserve( std::size_t count ) { m_values.reserve( count ); }
+    void clear() { m_values.clear(); }
+    std::size_t size() const { return m_values.size(); }
+
+    std::size_t allocated_bytes() const { return m_values.capacity() * sizeof( uint32_t ); }
+
+private:
+    std::vector<uint32_t> m_values;
+};
+
+/// Positions as Bits bit integers per axis on a grid spanning the bounds, 16 bits take 6 bytes and
+/// 21 bits take 8. The error per axis is at most half the bounds extent divided by 2^Bits - 1.
+/// Bounds given by set_bounds are fixed and positions outside them are clamped. Without them the grid
+/// spans the bounds of the stored positions: a position outside widens an axis to at least twice its
+/// extent and encodes the stored positions again, so a growing mesh is encoded O(log extent) times.
+/// Each of those rounds again, the error then stays within about one step of the final grid
+template<unsigned int Bits>
+class QuantizedPositions
+{
+    static_assert( Bits == 16 || Bits == 21, "positions are quantized to 16 or 21 bits" );
+
+    typedef typename std::conditional<Bits == 16, quantized::Position16, uint64_t>::type Word;
+
+public:
+    typedef const vec3 const_reference;
+
+    static const bool stored = true;
+
+    static const uint32_t max_value = ( 1u << Bits ) - 1;
+
+    explicit QuantizedPositions( const vec3 & fallback = vec3() ) { ( void )fallback; }
+
+    /// Span the grid over min to max and keep it there. Positions already stored are decoded and
+    /// encoded again, which loses precision; call it before adding any
+    void set_bounds( const vec3 & min, const vec3 & max )
+    {
+        regrid( min, max );
+        m_bounds_set = true;
+    }
+
+    inline bool bounds_set() const { return m_bounds_set; }
+
+    inline vec3 bounds_min() const { return vec3( m_min[0], m_min[1], m_min[2] ); }
+    inline vec3 bounds_max() const { return vec3( m_min[0] + m_step[0] * float( max_value ), m_min[1] + m_step[1] * float( max_value ), m_min[2] + m_step[2] * float( max_value ) ); }
+
+    const_reference operator[]( std::size_t index ) const
+    {
+        uint32_t x, y, z;
+        quantized::unpack( m_values[index], x, y, z );
+
+        vec3 position;
+#if defined( QUANTIZED_ATTRIBUTE_SSE2 )
+        const auto grid = _mm_cvtepi32_ps( _mm_set_epi32( 0, static_cast<int>( z ), static_cast<int>( y ), static_cast<int>( x ) ) );
+        const auto decoded = _mm_add_ps( _mm_loadu_ps( m_min ), _mm_mul_ps( grid, _mm_loadu_ps( m_step ) ) );
+
+        float lanes[4];
+        _mm_storeu_ps( lanes, decoded );
+        position = vec3( lanes[0], lanes[1], lanes[2] );
+#else
+        position = vec3( m_min[0] + float( x ) * m_step[0], m_min[1] + float( y ) * m_step[1], m_min[2] + float( z ) * m_step[2] );
+#endif
+        return position;
+    }
+
+    void set( std::size_t index, const vec3 & value )
+    {
+        fit( value );
+        m_values[index] = encode( value );
+    }
+
+    template<typename... Args>
+    void emplace_back( Args&& ...args )
+    {
+        const vec3 position( std::forward<Args>( args )... );
+        fit( position );
+        m_values.push_back( encode( position ) );
+    }
+
+    void reserve( std::size_t count ) { m_values.reserve( count ); }
+    void clear() { m_values.clear(); }
+    std::size_t size() const { return m_values.size(); }
+
+    std::size_t allocated_bytes() const { return m_values.capacity() * sizeof( Word ); }
+
+private:
+    Word encode( const vec3 & position ) const
+    {
+        Word word;
+        quantized::pack( word,
+                         quantized::quantize( position[0] - m_min[0], m_inverse_step[0], max_value ),
+                         quantized::quantize( position[1] - m_min[1], m_inverse_step[1], max_value ),
+                         quantized::quantize( position[2] - m_min[2], m_inverse_step[2], max_value ) );
+        return word;
+    }
+
+    /// Without set_bounds, widen the grid so it holds position. Positions within half a step of the
+    /// bounds round onto them, non finite axes are left to quantize()
+    void fit( const vec3 & position )
+    {
+        if( m_bounds_set ) return;
+
+        if( m_values.empty() )
+        {
+            regrid( position, position );
+            return;
+        }
+
+        auto min = bounds_min();
+        auto max = bounds_max();
+        auto outside = false;
+
+        for( int axis = 0; axis < 3; ++axis )
+        {
+            const auto value = position[axis];
+            const auto margin = 0.5f * m_step[axis];
+
+            if( !( value < min[axis] - margin || value > max[axis] + margin ) || !std::isfinite( value ) ) continue;
+
+            const auto extent = std::max( std::max( max[axis], value ) - std::min( min[axis], value ), 2.0f * ( max[axis] - min[axis] ) );
+
+            if( value < min[axis] )
+            {
+                min[axis] = max[axis] - extent;
+            }
+            else
+            {
+                max[axis] = min[axis] + extent;
+            }
+            outside = true;
+        }
+
+        if( outside )
+        {
+            regrid( min, max );
+        }
+    }
+
+    /// span the grid over min to max and encode the stored positions on it
+    void regrid( const vec3 & min, const vec3 & max )
+    {
+        std::vector<vec3> positions;
+        positions.reserve( m_values.size() );
+
+        for( std::size_t i = 0; i < m_values.size(); ++i )
+        {
+            positions.push_back( ( *this )[i] );
+        }
+
+        for( int axis = 0; axis < 3; ++axis )
+        {
+            const auto extent = max[axis] - min[axis];
+            m_min[axis] = min[axis];
+            m_step[axis] = extent > 0.0f ? extent / float( max_value ) : 0.0f;
+            m_inverse_step[axis] = extent > 0.0f ? float( max_value ) / extent : 0.0f;
+        }
+
+        for( std::size_t i = 0; i < positions.size(); ++i )
+        {
+            m_values[i] = encode( positions[i] );
+        }
+    }
+
+    std::vector<Word> m_values;
+
+    /// grid origin and spacing, the fourth lane pads them for 128 bit loads
+    float m_min[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float m_step[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float m_inverse_step[3] = { 0.0f, 0.0f, 0.0f };
+
+    bool m_bounds_set = false;
+};
+
+template<unsigned int Bits>
+const bool QuantizedPositions<Bits>::stored;
+
+template<unsigned int Bits>
+const uint32_t QuantizedPositions<Bits>::max_value;
+
+/// span the position grid of a mesh, nothing to do for positions stored as floats
+template<typename Positions>
+inline void set_quantization_bounds( Positions &, const vec3 &, const vec3 & ) {}
+
+template<unsigned int Bits>
+inline void set_quantization_bounds( QuantizedPositions<Bits> & positions, const vec3 & min, const vec3 & max )
+{
+    positions.set_bounds( min, max );
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/// Bump allocator for the temporaries of topology operations.
+/// Memory is handed out from blocks that are kept when the arena is rewound, so once the
+/// blocks have grown to the working set an operation does not touch the global allocator.
+/// Only trivially destructible types are allowed, nothing is destroyed on rewind.
+class ScratchArena
+{
+public:
+
+    /// rewinds the arena to where it was when the scope was opened, scopes may nest
+    class Scope
+    {
+    public:
+        explicit Scope( ScratchArena & arena ) : m_arena( arena ), m_block( arena.m_block ), m_offset( arena.m_offset ) {}
+
+        ~Scope()
+        {
+            m_arena.m_block = m_block;
+            m_arena.m_offset = m_offset;
+        }
+
+        Scope( const Scope & ) = delete;
+        Scope & operator=( const Scope & ) = delete;
+
+    private:
+        ScratchArena & m_arena;
+        std::size_t m_block;
+        std::size_t m_offset;
+    };
+
+    explicit ScratchArena( std::size_t block_size = 16384 ) : m_block_size( block_size ), m_block( 0 ), m_offset( 0 ) {}
+
+    ScratchArena( const ScratchArena & ) = delete;
+    ScratchArena & operator=( const ScratchArena & ) = delete;
+
+    /// uninitialized storage for count elements, valid until the enclosing scope ends
+    template<typename T>
+    T * allocate( std::size_t count )
+    {
+        static_assert( std::is_trivially_destructible<T>::value, "ScratchArena does not run destructors" );
+
+        const std::size_t bytes = count * sizeof( T );
+
+        while( true )
+        {
+            if( m_block < m_blocks.size() )
+            {
+                const auto & block = m_blocks[m_block];
+                const auto base = reinterpret_cast<std::uintptr_t>( block.data.get() );
+                const auto aligned = ( base + m_offset + alignof( T ) - 1 ) & ~std::uintptr_t( alignof( T ) - 1 );
+                const std::size_t offset = aligned - base;
+
+                if( offset + bytes <= block.size )
+                {
+                    m_offset = offset + bytes;
+                    return reinterpret_cast<T*>( aligned );
+                }
+
+                if( m_block + 1 < m_blocks.size() )
+                {
+                    ++m_block;
+                    m_offset = 0;
+                    continue;
+                }
+            }
+
+            /// no block left with room, the new block is kept for later operations
+            Block block;
+            block.size = std::max( m_block_size, bytes + alignof( T ) );
+            block.data.reset( new char[block.size] );
+            m_blocks.push_back( std::move( block ) );
+            m_block = m_blocks.size() - 1;
+            m_offset = 0;
+        }
+    }
+
+    /// release every allocation, the blocks are kept
+    void reset()
+    {
+        m_block = 0;
+        m_offset = 0;
+    }
+
+    /// bytes held by the blocks
+    std::size_t allocated_bytes() const
+    {
+        std::size_t bytes = 0;
+
+        for( const auto & block : m_blocks )
+        {
+            bytes += block.size;
+        }
+
+        return bytes;
+    }
+
+private:
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+
+    /// size of a new block, unless an allocation needs more
+    std::size_t m_block_size;
+
+    /// block and offset of the next allocation
+    std::size_t m_block;
+    std::size_t m_offset;
+};
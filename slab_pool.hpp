@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Chunked contiguous storage for mesh elements.
+/// Elements are constructed in place inside fixed size slabs. Growing the pool only
+/// appends a new slab, so an element never moves and raw pointers to it stay valid
+/// until the pool is cleared.
+template<typename T, std::size_t SlabSize = 4096>
+class SlabPool
+{
+    static_assert( ( SlabSize & ( SlabSize - 1 ) ) == 0, "SlabSize must be a power of two" );
+
+    typedef typename std::aligned_storage<sizeof( T ), alignof( T )>::type Storage;
+
+public:
+
+    template<typename Pool, typename Value>
+    class basic_iterator
+    {
+    public:
+        basic_iterator( Pool * pool, std::size_t index ) : m_pool( pool ), m_index( index ) {}
+
+        Value & operator*() const { return ( *m_pool )[m_index]; }
+        Value * operator->() const { return &( *m_pool )[m_index]; }
+        basic_iterator & operator++() { ++m_index; return *this; }
+        bool operator==( const basic_iterator & other ) const { return m_index == other.m_index; }
+        bool operator!=( const basic_iterator & other ) const { return m_index != other.m_index; }
+
+    private:
+        Pool * m_pool;
+        std::size_t m_index;
+    };
+
+    typedef basic_iterator<SlabPool, T> iterator;
+    typedef basic_iterator<const SlabPool, const T> const_iterator;
+
+    static const std::size_t slab_size = SlabSize;
+
+    SlabPool() : m_size( 0 ) {}
+
+    ~SlabPool()
+    {
+        clear();
+    }
+
+    SlabPool( const SlabPool & ) = delete;
+    SlabPool & operator=( const SlabPool & ) = delete;
+
+    /// construct a new element at the end of the pool
+    template<typename ...Args>
+    T & emplace_back( Args&& ...args )
+    {
+        if( m_size == capacity() )
+        {
+            allocate_slab();
+        }
+
+        T * slot = slot_at( m_size );
+        new( slot ) T( std::forward<Args>( args )... );
+        ++m_size;
+        return *slot;
+    }
+
+    /// Add count slots at the end of the pool without constructing them, returns the index of the first.
+    /// Every new slot has to be constructed with construct() before the pool is used otherwise; slots
+    /// are disjoint, so different threads can construct different ones
+    std::size_t grow( std::size_t count )
+    {
+        const auto first = m_size;
+        reserve( m_size + count );
+        m_size += count;
+        return first;
+    }
+
+    /// construct the element of a slot added by grow()
+    template<typename ...Args>
+    T & construct( std::size_t index, Args&& ...args )
+    {
+        assert( index < m_size );
+        T * slot = slot_at( index );
+        new( slot ) T( std::forward<Args>( args )... );
+        return *slot;
+    }
+
+    /// destroy the last element, its slab is kept for the next insertion
+    void pop_back()
+    {
+        assert( m_size > 0 );
+        slot_at( --m_size )->~T();
+    }
+
+    /// allocate slabs up front so the next count - size() insertions do not allocate
+    void reserve( std::size_t count )
+    {
+        while( capacity() < count )
+        {
+            allocate_slab();
+        }
+    }
+
+    /// destroy all elements and release every slab
+    void clear()
+    {
+        for( std::size_t i = 0; i < m_size; ++i )
+        {
+            slot_at( i )->~T();
+        }
+
+        m_size = 0;
+        m_slabs.clear();
+    }
+
+    /// exchange the elements of two pools, element addresses stay the same
+    void swap( SlabPool & other )
+    {
+        m_slabs.swap( other.m_slabs );
+        std::swap( m_size, other.m_size );
+    }
+
+    T & operator[]( std::size_t index )
+    {
+        assert( index < m_size );
+        return *slot_at( index );
+    }
+
+    const T & operator[]( std::size_t index ) const
+    {
+        assert( index < m_size );
+        return *slot_at( index );
+    }
+
+    T & back() { return ( *this )[m_size - 1]; }
+    const T & back() const { return ( *this )[m_size - 1]; }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::size_t capacity() const { return m_slabs.size() * SlabSize; }
+
+    /// bytes held by the slabs, including unused slots
+    std::size_t allocated_bytes() const { return capacity() * sizeof( Storage ); }
+
+    iterator begin() { return iterator( this, 0 ); }
+    iterator end() { return iterator( this, m_size ); }
+    const_iterator begin() const { return const_iterator( this, 0 ); }
+    const_iterator end() const { return const_iterator( this, m_size ); }
+
+private:
+
+    void allocate_slab()
+    {
+        m_slabs.emplace_back( new Storage[SlabSize] );
+    }
+
+    T * slot_at( std::size_t index ) const
+    {
+        return reinterpret_cast<T*>( &m_slabs[index / SlabSize][index % SlabSize] );
+    }
+
+    /// fixed size blocks of uninitialized element storage
+    std::vector<std::unique_ptr<Storage[]>> m_slabs;
+
+    /// number of constructed elements
+    std::size_t m_size;
+};
@@ -0,0 +1,42 @@
+#include "test_meshes.hpp"
+
+namespace
+{
+    size_t live_faces( const LinkedMesh & mesh )
+    {
+        return mesh.stats().live_faces;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Decimate, ClosedMeshStaysClosedAndManifold )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 10, true );
+    ASSERT_TRUE( test_meshes::valid_topology( mesh, true ) );
+
+    const auto faces = live_faces( mesh );
+
+    for( const auto target : { faces / 2, faces / 8, size_t( 12 ) } )
+    {
+        EXPECT_GT( mesh.decimate( target ), 0u );
+        EXPECT_LT( live_faces( mesh ), faces );
+        EXPECT_GE( live_faces( mesh ), target );
+
+        ASSERT_TRUE( test_meshes::valid_topology( mesh, true ) ) << "decimated to " << target;
+
+        /// a closed genus 0 mesh keeps its Euler characteristic
+        const auto stats = mesh.stats();
+        EXPECT_EQ( 2, static_cast<long long>( stats.live_vertices ) - static_cast<long long>( stats.live_edges / 2 ) + static_cast<long long>( stats.live_faces ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Decimate, RejectsPolygons )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 2, false );
+
+    EXPECT_EQ( 0u, mesh.decimate( 4 ) );
+    EXPECT_EQ( 24u, live_faces( mesh ) );
+}
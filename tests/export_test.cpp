@@ -0,0 +1,124 @@
+#include "test_meshes.hpp"
+
+#include <cstring>
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Triangles, ShortBufferIsLeftUntouched )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 3, false );
+
+    const auto vertex_count = mesh.triangle_vertex_count();
+    const auto float_count = mesh.triangle_float_count();
+
+    /// every element keeps the marker when the capacity is one short
+    Mesh::Vertex marker;
+    marker.light = 42.0f;
+    std::vector<Mesh::Vertex> vertices( vertex_count, marker );
+
+    EXPECT_EQ( 0u, mesh.triangles( vertices.data(), vertex_count - 1 ) );
+
+    for( const auto & vertex : vertices )
+    {
+        ASSERT_EQ( 42.0f, vertex.light );
+    }
+
+    EXPECT_EQ( vertex_count, mesh.triangles( vertices.data(), vertex_count ) );
+
+    std::vector<float> positions( float_count, -7.0f );
+    std::vector<float> colors( float_count, -7.0f );
+
+    EXPECT_EQ( 0u, mesh.triangles( positions.data(), colors.data(), float_count - 4 ) );
+    EXPECT_EQ( std::vector<float>( float_count, -7.0f ), positions );
+    EXPECT_EQ( std::vector<float>( float_count, -7.0f ), colors );
+
+    EXPECT_EQ( float_count, mesh.triangles( positions.data(), colors.data(), float_count ) );
+
+    /// the vector overloads write the same as the checked ones
+    std::vector<float> expected_positions;
+    std::vector<float> expected_colors;
+    mesh.triangles( expected_positions, expected_colors );
+    EXPECT_EQ( expected_positions, positions );
+    EXPECT_EQ( expected_colors, colors );
+}
+
+namespace
+{
+    ::testing::AssertionResult matches_full_export( LinkedMesh & mesh, const std::vector<Mesh::Vertex> & incremental )
+    {
+        std::vector<Mesh::Vertex> full;
+        mesh.triangles( full );
+
+        if( full.size() != incremental.size() || std::memcmp( full.data(), incremental.data(), full.size() * sizeof( Mesh::Vertex ) ) != 0 )
+        {
+            return ::testing::AssertionFailure() << "incremental export differs from triangles()";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    size_t changed_bytes( const std::vector<LinkedMesh::ExportRange> & changed )
+    {
+        size_t bytes = 0;
+
+        for( const auto & range : changed )
+        {
+            bytes += range.size;
+        }
+        return bytes;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( TrianglesIncremental, DirtyVertexRewritesItsFaces )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 8, false );
+
+    std::vector<Mesh::Vertex> vertices;
+    std::vector<LinkedMesh::ExportRange> changed;
+    mesh.triangles_incremental( vertices, changed );
+
+    /// the first edit may wait for the fan check, the later ones queue the one ring right away
+    for( size_t id = 0; id < 3; ++id )
+    {
+        const auto vertex = mesh.vertex( id * 37 );
+        vertex->position = vertex->position * 1.5f;
+        mesh.mark_dirty( vertex );
+
+        mesh.triangles_incremental( vertices, changed );
+        EXPECT_TRUE( matches_full_export( mesh, vertices ) );
+
+        /// a cube vertex is used by at most four quads
+        EXPECT_GT( changed_bytes( changed ), 0u );
+        EXPECT_LE( changed_bytes( changed ), 4 * 6 * sizeof( Mesh::Vertex ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( TrianglesIncremental, DirtyPinchVertexRewritesEveryFan )
+{
+    LinkedMesh mesh;
+    LinkedMesh::VertexHandle pinch;
+
+    {
+        /// two fans meeting only at the origin
+        LinkedMeshBuilder builder( mesh );
+        builder.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) );
+        builder.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ), vec3( -1.0f, 0.0f, 0.0f ) );
+        builder.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 0.0f, -1.0f, 0.0f ), vec3( 1.0f, -1.0f, 0.0f ) );
+        pinch = builder.find_vertex( vec3( 0.0f, 0.0f, 0.0f ) );
+    }
+
+    std::vector<Mesh::Vertex> vertices;
+    std::vector<LinkedMesh::ExportRange> changed;
+    mesh.triangles_incremental( vertices, changed );
+
+    for( int step = 1; step <= 2; ++step )
+    {
+        pinch->position = vec3( 0.0f, 0.0f, float( step ) );
+        mesh.mark_dirty( pinch );
+
+        mesh.triangles_incremental( vertices, changed );
+        EXPECT_TRUE( matches_full_export( mesh, vertices ) ) << "step " << step;
+    }
+}
@@ -0,0 +1,119 @@
+#include "test_meshes.hpp"
+
+#include "core/mesh/MeshImporter.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const std::string ply_path = ::testing::TempDir() + "halfedge_importer_test.ply";
+
+    const char * const triangle_vertices =
+        "0 0 0\n"
+        "1 0 0\n"
+        "0 1 0\n";
+
+    void write_file( const std::string & contents )
+    {
+        std::ofstream file( ply_path, std::ios::binary | std::ios::trunc );
+        file.write( contents.data(), static_cast<std::streamsize>( contents.size() ) );
+    }
+
+    std::string ascii_header( const std::string & vertex_count, const std::string & face_count )
+    {
+        return "ply\n"
+               "format ascii 1.0\n"
+               "element vertex " + vertex_count + "\n"
+               "property float x\n"
+               "property float y\n"
+               "property float z\n"
+               "element face " + face_count + "\n"
+               "property list uchar int vertex_indices\n"
+               "end_header\n";
+    }
+
+    /// import ply_path into an empty mesh, a rejected header has to leave it empty
+    bool import_file( const bool header_rejected = false )
+    {
+        LinkedMesh mesh;
+        MeshImporter importer( mesh );
+
+        const bool result = importer.import_ply( ply_path );
+
+        if( header_rejected )
+        {
+            EXPECT_EQ( 0u, mesh.vertex_count() + mesh.face_count() );
+        }
+
+        return result;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( ImportPly, AsciiTriangle )
+{
+    write_file( ascii_header( "3", "1" ) + triangle_vertices + "3 0 1 2\n" );
+
+    LinkedMesh mesh;
+    MeshImporter importer( mesh );
+
+    ASSERT_TRUE( importer.import_ply( ply_path ) );
+    EXPECT_EQ( 3u, importer.vertex_count() );
+    EXPECT_EQ( 1u, importer.face_count() );
+    EXPECT_TRUE( test_meshes::valid_topology( mesh, false ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( ImportPly, RejectsHeaderCounts )
+{
+    /// a negative count would wrap around to a huge size_t
+    write_file( ascii_header( "3", "-1" ) + triangle_vertices + "3 0 1 2\n" );
+    EXPECT_FALSE( import_file( true ) );
+
+    write_file( ascii_header( "3", "1x" ) + triangle_vertices + "3 0 1 2\n" );
+    EXPECT_FALSE( import_file( true ) );
+
+    write_file( ascii_header( "3", "99999999999999999999" ) + triangle_vertices + "3 0 1 2\n" );
+    EXPECT_FALSE( import_file( true ) );
+
+    /// fits in the counts but not in the file, nothing is reserved for it
+    write_file( ascii_header( "3", "1000000000000" ) + triangle_vertices + "3 0 1 2\n" );
+    EXPECT_FALSE( import_file( true ) );
+
+    write_file( ascii_header( "3", "1" ) );
+    EXPECT_FALSE( import_file( true ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( ImportPly, RejectsIndicesOutsideInt64 )
+{
+    write_file( ascii_header( "3", "1" ) + triangle_vertices + "3 0 1 nan\n" );
+    EXPECT_FALSE( import_file() );
+
+    write_file( ascii_header( "3", "1" ) + triangle_vertices + "3 0 1 1e300\n" );
+    EXPECT_FALSE( import_file() );
+
+    /// float indices in a binary file
+    std::string binary =
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 1\n"
+        "property list uchar float vertex_indices\n"
+        "end_header\n";
+
+    const float positions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+    const float indices[3] = { 0.0f, 1.0f, std::numeric_limits<float>::quiet_NaN() };
+    const char corners = 3;
+
+    binary.append( reinterpret_cast<const char *>( positions ), sizeof( positions ) );
+    binary.append( &corners, 1 );
+    binary.append( reinterpret_cast<const char *>( indices ), sizeof( indices ) );
+
+    write_file( binary );
+    EXPECT_FALSE( import_file() );
+}
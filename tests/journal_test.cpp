@@ -0,0 +1,134 @@
+#include "test_meshes.hpp"
+
+#include "core/mesh/MeshJournal.hpp"
+
+namespace
+{
+    const std::string snapshot_path = ::testing::TempDir() + "halfedge_journal_test.bin";
+
+    std::vector<char> state( const LinkedMesh & mesh )
+    {
+        return test_meshes::snapshot_bytes( mesh, snapshot_path );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Journal, UndoRedoIsBitwiseIdentical )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 8, true );
+
+    MeshJournal journal( mesh );
+    std::vector<std::vector<char>> states( 1, state( mesh ) );
+
+    /// edits that change attributes, add elements and fill the free lists
+    mesh.set_color( 5u, vec4( 1.0f, 0.0f, 0.0f, 1.0f ) );
+    ASSERT_TRUE( journal.commit() );
+    states.push_back( state( mesh ) );
+
+    mesh.decimate( mesh.face_count() / 2 );
+    ASSERT_TRUE( journal.commit() );
+    states.push_back( state( mesh ) );
+
+    mesh.add_face( vec3( 0.0f, 0.0f, 3.0f ), vec3( 1.0f, 0.0f, 3.0f ), vec3( 1.0f, 1.0f, 3.0f ), vec3( 0.0f, 1.0f, 3.0f ) );
+    ASSERT_TRUE( journal.commit() );
+    states.push_back( state( mesh ) );
+
+    EXPECT_FALSE( journal.commit() );
+    ASSERT_EQ( 3u, journal.undo_count() );
+
+    for( size_t i = states.size() - 1; i > 0; --i )
+    {
+        ASSERT_TRUE( journal.undo() );
+        EXPECT_EQ( states[i - 1], state( mesh ) ) << "after undoing commit " << i;
+    }
+    EXPECT_FALSE( journal.undo() );
+
+    for( size_t i = 1; i < states.size(); ++i )
+    {
+        ASSERT_TRUE( journal.redo() );
+        EXPECT_EQ( states[i], state( mesh ) ) << "after redoing commit " << i;
+    }
+    EXPECT_FALSE( journal.redo() );
+
+    EXPECT_TRUE( test_meshes::valid_topology( mesh, false ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Journal, UndoDropsUncommittedChanges )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 4, true );
+
+    MeshJournal journal( mesh );
+    const auto start = state( mesh );
+
+    mesh.set_color( 2u, vec4( 0.0f, 1.0f, 0.0f, 1.0f ) );
+    ASSERT_TRUE( journal.commit() );
+    const auto committed = state( mesh );
+
+    /// not committed, undo and redo start from the committed state
+    mesh.decimate( mesh.face_count() / 2 );
+
+    ASSERT_TRUE( journal.undo() );
+    EXPECT_EQ( start, state( mesh ) );
+
+    mesh.set_color( 3u, vec4( 0.0f, 0.0f, 1.0f, 1.0f ) );
+
+    ASSERT_TRUE( journal.redo() );
+    EXPECT_EQ( committed, state( mesh ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Journal, LoggedAndHandleEditsUndoBitwise )
+{
+    LinkedMesh mesh;
+    test_meshes::add_cube( mesh, 4, false );
+
+    MeshJournal journal( mesh );
+    std::vector<std::vector<char>> states( 1, state( mesh ) );
+
+    auto commit = [&]()
+    {
+        ASSERT_TRUE( journal.commit() );
+        states.push_back( state( mesh ) );
+    };
+
+    /// every operation goes through the change log, except the handle edit reported by mark_dirty
+    const auto quad = mesh.add_face( vec3( 5.0f, 0.0f, 0.0f ), vec3( 6.0f, 0.0f, 0.0f ), vec3( 6.0f, 1.0f, 0.0f ), vec3( 5.0f, 1.0f, 0.0f ) );
+    mesh.extrude_face( quad, vec3( 0.0f, 0.0f, 0.5f ) );
+    commit();
+
+    mesh.extrude_faces( std::vector<LinkedMesh::FaceHandle>{ mesh.face( 7 ), mesh.face( 8 ) }, vec3( 0.5f, 0.0f, 0.0f ) );
+    commit();
+
+    mesh.set_color( mesh.face( 9 ), vec4( 0.0f, 1.0f, 0.0f, 1.0f ) );
+    mesh.set_texcoord( 10u, std::vector<vec2>( 4, vec2( 0.5f, 0.5f ) ) );
+    mesh.compute_normals();
+    commit();
+
+    const auto triangle = mesh.add_face( vec3( 8.0f, 0.0f, 0.0f ), vec3( 9.0f, 0.0f, 0.0f ), vec3( 8.0f, 1.0f, 0.0f ) );
+    mesh.extrude_edge( triangle->edge, vec3( 0.0f, -1.0f, 0.0f ) );
+    commit();
+
+    mesh.face( 11 )->color = vec4( 0.2f, 0.2f, 0.2f, 1.0f );
+    mesh.mark_dirty( mesh.face( 11 ) );
+    mesh.set_color( 12u, vec4( 0.0f, 0.0f, 1.0f, 1.0f ) );
+    commit();
+
+    mesh.reset();
+    mesh.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) );
+    commit();
+
+    for( size_t i = states.size() - 1; i > 0; --i )
+    {
+        ASSERT_TRUE( journal.undo() );
+        EXPECT_EQ( states[i - 1], state( mesh ) ) << "after undoing commit " << i;
+    }
+
+    for( size_t i = 1; i < states.size(); ++i )
+    {
+        ASSERT_TRUE( journal.redo() );
+        EXPECT_EQ( states[i], state( mesh ) ) << "after redoing commit " << i;
+    }
+}
@@ -0,0 +1,72 @@
+#include "test_meshes.hpp"
+
+#include "core/mesh/ConcurrentMeshBuilder.hpp"
+
+namespace
+{
+    const int grid_size = 48;
+
+    /// unit quads of rows [first_row, last_row) of a grid_size x grid_size grid
+    void add_rows( LinkedMeshBuilder & builder, const int first_row, const int last_row )
+    {
+        for( int i = first_row; i < last_row; ++i )
+        {
+            for( int j = 0; j < grid_size; ++j )
+            {
+                const auto x = float( i );
+                const auto y = float( j );
+
+                builder.add_face( vec3( x, y, 0.0f ), vec3( x + 1.0f, y, 0.0f ), vec3( x + 1.0f, y + 1.0f, 0.0f ), vec3( x, y + 1.0f, 0.0f ) );
+            }
+        }
+    }
+
+    size_t open_edges( LinkedMesh & mesh )
+    {
+        size_t count = 0;
+
+        for( size_t i = 0; i < mesh.edge_count(); ++i )
+        {
+            const auto edge = mesh.edge( i );
+
+            if( edge->initialized && edge->face != nullptr && edge->opposing == nullptr )
+            {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( ConcurrentMerge, RowsOfEveryWorkerAndRoundFormOneGrid )
+{
+    const int rounds = 3;
+
+    for( const unsigned int thread_count : { 1u, 3u, 8u } )
+    {
+        LinkedMesh mesh;
+        ConcurrentMeshBuilder builder( mesh, thread_count );
+
+        for( int round = 0; round < rounds; ++round )
+        {
+            const int first = grid_size * round / rounds;
+            const int last = grid_size * ( round + 1 ) / rounds;
+
+            builder.run( [&]( const unsigned int worker, LinkedMeshBuilder & worker_builder )
+            {
+                add_rows( worker_builder, first + ( last - first ) * int( worker ) / int( thread_count ),
+                                          first + ( last - first ) * int( worker + 1 ) / int( thread_count ) );
+            } );
+
+            builder.merge();
+        }
+
+        const auto stats = mesh.stats();
+        EXPECT_EQ( size_t( ( grid_size + 1 ) * ( grid_size + 1 ) ), stats.live_vertices ) << thread_count << " threads";
+        EXPECT_EQ( size_t( grid_size * grid_size ), stats.live_faces ) << thread_count << " threads";
+        EXPECT_EQ( size_t( 4 * grid_size ), open_edges( mesh ) ) << thread_count << " threads";
+        EXPECT_TRUE( test_meshes::valid_topology( mesh, false ) ) << thread_count << " threads";
+    }
+}
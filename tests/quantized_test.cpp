@@ -0,0 +1,62 @@
+#include "core/mesh/CompactLinkedMesh.hpp"
+#include "core/mesh/quantized_attribute.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( QuantizedPositions, GridFollowsTheBoundsWithoutSetBounds )
+{
+    QuantizedPositions<21> stored;
+    std::vector<vec3> positions;
+
+    /// a spiral growing away from the origin, so the bounds keep widening
+    for( int i = 0; i < 2000; ++i )
+    {
+        const auto radius = 0.01f * float( i );
+        positions.push_back( vec3( radius * std::cos( 0.1f * float( i ) ), radius * std::sin( 0.1f * float( i ) ), -0.5f * radius ) );
+        stored.emplace_back( positions.back() );
+    }
+
+    EXPECT_FALSE( stored.bounds_set() );
+
+    const auto min = stored.bounds_min();
+    const auto max = stored.bounds_max();
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+        /// every encode again rounds to the wider grid, together within about one step of the last one
+        const auto step = ( max[axis] - min[axis] ) / float( QuantizedPositions<21>::max_value );
+        float error = 0.0f;
+
+        for( size_t i = 0; i < positions.size(); ++i )
+        {
+            EXPECT_LE( min[axis], positions[i][axis] );
+            EXPECT_GE( max[axis], positions[i][axis] );
+            error = std::max( error, std::fabs( stored[i][axis] - positions[i][axis] ) );
+        }
+        EXPECT_LE( error, 1.5f * step ) << "axis " << axis;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( QuantizedPositions, SetBoundsClampsOutside )
+{
+    QuantizedLinkedMesh mesh;
+    mesh.set_bounds( vec3( -1.0f, -1.0f, -1.0f ), vec3( 1.0f, 1.0f, 1.0f ) );
+
+    const auto inside = mesh.add_vertex( vec3( 0.25f, -0.5f, 0.75f ) );
+    const auto outside = mesh.add_vertex( vec3( 3.0f, -3.0f, 0.0f ) );
+
+    const auto step = 2.0f / float( ( 1u << 21 ) - 1 );
+    const auto position = mesh.position( inside );
+    EXPECT_NEAR( position[0], 0.25f, step );
+    EXPECT_NEAR( position[1], -0.5f, step );
+    EXPECT_NEAR( position[2], 0.75f, step );
+
+    EXPECT_NEAR( mesh.position( outside )[0], 1.0f, step );
+    EXPECT_NEAR( mesh.position( outside )[1], -1.0f, step );
+}
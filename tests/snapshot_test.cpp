@@ -0,0 +1,139 @@
+#include "test_meshes.hpp"
+
+#include "core/mesh/mesh_snapshot.hpp"
+
+#include <cstring>
+
+namespace
+{
+    const std::string snapshot_path = ::testing::TempDir() + "halfedge_snapshot_test.bin";
+
+    template<typename Handle>
+    inline long long id_of( const Handle handle )
+    {
+        return handle == nullptr ? -1 : static_cast<long long>( handle->id );
+    }
+
+    /// decimated cube, so the free lists are not empty
+    void build_mesh( LinkedMesh & mesh )
+    {
+        test_meshes::add_cube( mesh, 6, true );
+        mesh.set_color( 3u, vec4( 1.0f, 0.0f, 0.0f, 1.0f ) );
+        mesh.decimate( mesh.face_count() / 2 );
+    }
+
+    std::vector<Mesh::Vertex> exported( LinkedMesh & mesh )
+    {
+        std::vector<Mesh::Vertex> vertices;
+        mesh.triangles( vertices );
+        return vertices;
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Snapshot, SaveLoadPreservesTopology )
+{
+    LinkedMesh mesh;
+    build_mesh( mesh );
+    ASSERT_GT( mesh.stats().free_faces, 0u );
+    ASSERT_TRUE( mesh.save_snapshot( snapshot_path ) );
+
+    LinkedMesh loaded;
+    ASSERT_TRUE( loaded.load_snapshot( snapshot_path ) );
+
+    ASSERT_EQ( mesh.vertex_count(), loaded.vertex_count() );
+    ASSERT_EQ( mesh.edge_count(), loaded.edge_count() );
+    ASSERT_EQ( mesh.face_count(), loaded.face_count() );
+
+    const auto stats = mesh.stats();
+    const auto loaded_stats = loaded.stats();
+    EXPECT_EQ( stats.live_vertices, loaded_stats.live_vertices );
+    EXPECT_EQ( stats.live_edges, loaded_stats.live_edges );
+    EXPECT_EQ( stats.live_faces, loaded_stats.live_faces );
+    EXPECT_EQ( stats.free_vertices, loaded_stats.free_vertices );
+    EXPECT_EQ( stats.free_edges, loaded_stats.free_edges );
+    EXPECT_EQ( stats.free_faces, loaded_stats.free_faces );
+
+    for( size_t i = 0; i < mesh.vertex_count(); ++i )
+    {
+        const auto vertex = mesh.vertex( i );
+        const auto copy = loaded.vertex( i );
+
+        EXPECT_EQ( vertex->initialized, copy->initialized ) << "vertex " << i;
+        EXPECT_EQ( id_of( vertex->edge ), id_of( copy->edge ) ) << "vertex " << i;
+        EXPECT_TRUE( vertex->position == copy->position ) << "vertex " << i;
+        EXPECT_TRUE( vertex->color == copy->color ) << "vertex " << i;
+    }
+
+    for( size_t i = 0; i < mesh.edge_count(); ++i )
+    {
+        const auto edge = mesh.edge( i );
+        const auto copy = loaded.edge( i );
+
+        EXPECT_EQ( edge->initialized, copy->initialized ) << "halfedge " << i;
+        EXPECT_EQ( id_of( edge->vertex ), id_of( copy->vertex ) ) << "halfedge " << i;
+        EXPECT_EQ( id_of( edge->next ), id_of( copy->next ) ) << "halfedge " << i;
+        EXPECT_EQ( id_of( edge->opposing ), id_of( copy->opposing ) ) << "halfedge " << i;
+        EXPECT_EQ( id_of( edge->face ), id_of( copy->face ) ) << "halfedge " << i;
+    }
+
+    for( size_t i = 0; i < mesh.face_count(); ++i )
+    {
+        EXPECT_EQ( mesh.face( i )->initialized, loaded.face( i )->initialized ) << "face " << i;
+        EXPECT_EQ( id_of( mesh.face( i )->edge ), id_of( loaded.face( i )->edge ) ) << "face " << i;
+    }
+
+    EXPECT_TRUE( test_meshes::valid_topology( loaded, true ) );
+
+    const auto vertices = exported( mesh );
+    const auto loaded_vertices = exported( loaded );
+    ASSERT_EQ( vertices.size(), loaded_vertices.size() );
+    EXPECT_EQ( 0, std::memcmp( vertices.data(), loaded_vertices.data(), vertices.size() * sizeof( Mesh::Vertex ) ) );
+
+    /// the free lists come back in order too, saving again writes the same file
+    EXPECT_EQ( test_meshes::read_file( snapshot_path ), test_meshes::snapshot_bytes( loaded, snapshot_path ) );
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Snapshot, RejectedFileLeavesMeshUntouched )
+{
+    LinkedMesh mesh;
+    build_mesh( mesh );
+
+    const auto bytes = test_meshes::snapshot_bytes( mesh, snapshot_path );
+    ASSERT_FALSE( bytes.empty() );
+
+    LinkedMesh target;
+    test_meshes::add_cube( target, 2, false );
+    const auto before = test_meshes::snapshot_bytes( target, snapshot_path + ".target" );
+
+    {
+        std::ofstream truncated( snapshot_path, std::ios::binary | std::ios::trunc );
+        truncated.write( bytes.data(), static_cast<std::streamsize>( bytes.size() / 2 ) );
+    }
+
+    EXPECT_FALSE( target.load_snapshot( snapshot_path ) );
+    EXPECT_FALSE( target.load_snapshot( snapshot_path + ".missing" ) );
+
+    {
+        /// a triangle whose loop is cut to two halfedges, the third one keeps its links but leaves the face
+        LinkedMesh triangle;
+        triangle.add_face( vec3( 0.0f, 0.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) );
+        auto two_edges = test_meshes::snapshot_bytes( triangle, snapshot_path );
+        ASSERT_FALSE( two_edges.empty() );
+
+        const auto edge_offset = mesh_snapshot::aligned_size( sizeof( mesh_snapshot::Header ) ) +
+                                 mesh_snapshot::aligned_size( triangle.vertex_count() * sizeof( mesh_snapshot::VertexRecord ) );
+        const auto records = reinterpret_cast<mesh_snapshot::EdgeRecord *>( two_edges.data() + edge_offset );
+
+        records[1].next = 0;
+        records[2].face = mesh_snapshot::invalid_index;
+
+        std::ofstream file( snapshot_path, std::ios::binary | std::ios::trunc );
+        file.write( two_edges.data(), static_cast<std::streamsize>( two_edges.size() ) );
+    }
+
+    EXPECT_FALSE( target.load_snapshot( snapshot_path ) );
+
+    EXPECT_EQ( before, test_meshes::snapshot_bytes( target, snapshot_path + ".target" ) );
+}
@@ -0,0 +1,153 @@
+#include "test_meshes.hpp"
+
+namespace
+{
+    struct Counts
+    {
+        size_t vertices;
+        size_t edges;
+        size_t halfedges;
+        size_t faces;
+        size_t open;
+    };
+
+    /// live elements, edges counts a linked pair of halfedges once
+    Counts count( LinkedMesh & mesh )
+    {
+        Counts counts = { 0, 0, 0, 0, 0 };
+
+        const auto stats = mesh.stats();
+        counts.vertices = stats.live_vertices;
+        counts.halfedges = stats.live_edges;
+        counts.faces = stats.live_faces;
+
+        for( size_t i = 0; i < mesh.edge_count(); ++i )
+        {
+            const auto edge = mesh.edge( i );
+
+            if( !edge->initialized ) continue;
+
+            if( edge->opposing == nullptr )
+            {
+                ++counts.open;
+            }
+        }
+
+        counts.edges = ( counts.halfedges - counts.open ) / 2 + counts.open;
+        return counts;
+    }
+
+    /// open grid of quads in the xy plane, split into triangles when triangles is set
+    void add_grid( LinkedMesh & mesh, const int size, const bool triangles )
+    {
+        LinkedMeshBuilder builder( mesh );
+
+        for( int i = 0; i < size; ++i )
+        {
+            for( int j = 0; j < size; ++j )
+            {
+                const vec3 p0( float( i ), float( j ), 0.0f );
+                const vec3 p1( float( i + 1 ), float( j ), 0.0f );
+                const vec3 p2( float( i + 1 ), float( j + 1 ), 0.0f );
+                const vec3 p3( float( i ), float( j + 1 ), 0.0f );
+
+                if( triangles )
+                {
+                    builder.add_face( p0, p1, p2 );
+                    builder.add_face( p0, p2, p3 );
+                }
+                else
+                {
+                    builder.add_face( p0, p1, p2, p3 );
+                }
+            }
+        }
+    }
+
+    /// one Catmull-Clark level adds a point per edge and face and splits every n-gon into n quads
+    void expect_catmull_clark( LinkedMesh & mesh, const bool closed )
+    {
+        const auto before = count( mesh );
+        ASSERT_TRUE( mesh.subdivide( LinkedMesh::Subdivision::CatmullClark ) );
+        const auto after = count( mesh );
+
+        EXPECT_EQ( before.vertices + before.edges + before.faces, after.vertices );
+        EXPECT_EQ( before.halfedges, after.faces );
+        EXPECT_EQ( 4 * before.halfedges, after.halfedges );
+        EXPECT_EQ( 2 * before.open, after.open );
+        EXPECT_EQ( after.vertices, mesh.vertex_count() );
+        EXPECT_TRUE( test_meshes::valid_topology( mesh, closed ) );
+    }
+
+    /// one Loop level adds a point per edge and splits every triangle into four
+    void expect_loop( LinkedMesh & mesh, const bool closed )
+    {
+        const auto before = count( mesh );
+        ASSERT_TRUE( mesh.subdivide( LinkedMesh::Subdivision::Loop ) );
+        const auto after = count( mesh );
+
+        EXPECT_EQ( before.vertices + before.edges, after.vertices );
+        EXPECT_EQ( 4 * before.faces, after.faces );
+        EXPECT_EQ( 4 * before.halfedges, after.halfedges );
+        EXPECT_EQ( 2 * before.open, after.open );
+        EXPECT_EQ( after.vertices, mesh.vertex_count() );
+        EXPECT_TRUE( test_meshes::valid_topology( mesh, closed ) );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Subdivide, CatmullClarkCounts )
+{
+    LinkedMesh cube;
+    test_meshes::add_cube( cube, 2, false );
+
+    for( int level = 0; level < 3; ++level )
+    {
+        expect_catmull_clark( cube, true );
+    }
+
+    /// mixed triangles and quads, and an open border
+    LinkedMesh grid;
+    add_grid( grid, 4, true );
+    grid.add_face( vec3( 0.0f, 0.0f, 5.0f ), vec3( 1.0f, 0.0f, 5.0f ), vec3( 1.0f, 1.0f, 5.0f ), vec3( 0.0f, 1.0f, 5.0f ) );
+
+    for( int level = 0; level < 2; ++level )
+    {
+        expect_catmull_clark( grid, false );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Subdivide, LoopCounts )
+{
+    LinkedMesh cube;
+    test_meshes::add_cube( cube, 2, true );
+
+    for( int level = 0; level < 3; ++level )
+    {
+        expect_loop( cube, true );
+    }
+
+    LinkedMesh grid;
+    add_grid( grid, 4, true );
+
+    for( int level = 0; level < 2; ++level )
+    {
+        expect_loop( grid, false );
+    }
+}
+
+/// ////////////////////////////////////////////////////////////////////////////
+TEST( Subdivide, LoopRejectsPolygons )
+{
+    LinkedMesh grid;
+    add_grid( grid, 2, false );
+
+    const auto before = count( grid );
+    EXPECT_FALSE( grid.subdivide( LinkedMesh::Subdivision::Loop ) );
+
+    const auto after = count( grid );
+    EXPECT_EQ( before.vertices, after.vertices );
+    EXPECT_EQ( before.halfedges, after.halfedges );
+    EXPECT_EQ( before.faces, after.faces );
+}
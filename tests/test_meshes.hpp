@@ -0,0 +1,160 @@
+#pragma once
+
+#include "core/mesh/LinkedMesh.hpp"
+#include "core/mesh/LinkedMeshBuilder.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/// Meshes and checks shared by the tests
+namespace test_meshes
+{
+    /// Closed cube from -1 to 1 with divisions x divisions quads per side, split into two triangles each
+    /// when triangles is set. Welded and linked, every face winds counter clockwise seen from outside
+    inline void add_cube( LinkedMesh & mesh, const int divisions, const bool triangles )
+    {
+        LinkedMeshBuilder builder( mesh );
+
+        /// normal and two axes of every side, first axis cross second axis is the normal
+        const vec3 sides[6][3] =
+        {
+            { vec3(  1.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ), vec3( 0.0f, 0.0f, 1.0f ) },
+            { vec3( -1.0f, 0.0f, 0.0f ), vec3( 0.0f, 0.0f, 1.0f ), vec3( 0.0f, 1.0f, 0.0f ) },
+            { vec3( 0.0f,  1.0f, 0.0f ), vec3( 0.0f, 0.0f, 1.0f ), vec3( 1.0f, 0.0f, 0.0f ) },
+            { vec3( 0.0f, -1.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 0.0f, 0.0f, 1.0f ) },
+            { vec3( 0.0f, 0.0f,  1.0f ), vec3( 1.0f, 0.0f, 0.0f ), vec3( 0.0f, 1.0f, 0.0f ) },
+            { vec3( 0.0f, 0.0f, -1.0f ), vec3( 0.0f, 1.0f, 0.0f ), vec3( 1.0f, 0.0f, 0.0f ) }
+        };
+
+        for( const auto & side : sides )
+        {
+            auto corner = [&]( const int i, const int j )
+            {
+                const auto u = -1.0f + 2.0f * float( i ) / float( divisions );
+                const auto v = -1.0f + 2.0f * float( j ) / float( divisions );
+                return side[0] + side[1] * u + side[2] * v;
+            };
+
+            for( int i = 0; i < divisions; ++i )
+            {
+                for( int j = 0; j < divisions; ++j )
+                {
+                    if( triangles )
+                    {
+                        builder.add_face( corner( i, j ), corner( i + 1, j ), corner( i + 1, j + 1 ) );
+                        builder.add_face( corner( i, j ), corner( i + 1, j + 1 ), corner( i, j + 1 ) );
+                    }
+                    else
+                    {
+                        builder.add_face( corner( i, j ), corner( i + 1, j ), corner( i + 1, j + 1 ), corner( i, j + 1 ) );
+                    }
+                }
+            }
+        }
+    }
+
+    /// Every live face is a loop of live halfedges pointing back at it, linked halfedges are linked to
+    /// each other and run the other way. A closed mesh has no unlinked halfedge and the fan around
+    /// every vertex reaches all halfedges leaving it, which makes it manifold
+    inline ::testing::AssertionResult valid_topology( LinkedMesh & mesh, const bool closed )
+    {
+        std::vector<size_t> outgoing( mesh.vertex_count(), 0 );
+
+        for( size_t i = 0; i < mesh.face_count(); ++i )
+        {
+            const auto face = mesh.face( i );
+
+            if( !face->initialized ) continue;
+
+            if( face->edge == nullptr )
+            {
+                return ::testing::AssertionFailure() << "face " << i << " has no halfedge";
+            }
+
+            size_t count = 0;
+
+            for( const auto edge : mesh.edges( face ) )
+            {
+                if( ++count > mesh.edge_count() )
+                {
+                    return ::testing::AssertionFailure() << "the loop of face " << i << " does not close";
+                }
+
+                if( !edge->initialized || edge->face != face || edge->vertex == nullptr || !edge->vertex->initialized )
+                {
+                    return ::testing::AssertionFailure() << "halfedge " << edge->id << " of face " << i << " is broken";
+                }
+            }
+        }
+
+        for( size_t i = 0; i < mesh.edge_count(); ++i )
+        {
+            const auto edge = mesh.edge( i );
+
+            if( !edge->initialized ) continue;
+
+            if( edge->opposing == nullptr )
+            {
+                if( closed )
+                {
+                    return ::testing::AssertionFailure() << "halfedge " << i << " of a closed mesh is open";
+                }
+                continue;
+            }
+
+            if( edge->opposing->opposing != edge || !edge->opposing->initialized )
+            {
+                return ::testing::AssertionFailure() << "halfedge " << i << " is not linked back";
+            }
+
+            if( edge->opposing->vertex != edge->next->vertex )
+            {
+                return ::testing::AssertionFailure() << "halfedge " << i << " runs the same way as its opposing one";
+            }
+
+            ++outgoing[edge->vertex->id];
+        }
+
+        if( closed )
+        {
+            for( size_t i = 0; i < mesh.vertex_count(); ++i )
+            {
+                const auto vertex = mesh.vertex( i );
+
+                if( !vertex->initialized || outgoing[i] == 0 ) continue;
+
+                size_t fan = 0;
+
+                for( const auto edge : mesh.one_ring( vertex ) )
+                {
+                    if( edge->vertex != vertex || ++fan > outgoing[i] ) break;
+                }
+
+                if( fan != outgoing[i] )
+                {
+                    return ::testing::AssertionFailure() << "vertex " << i << " is not manifold";
+                }
+            }
+        }
+
+        return ::testing::AssertionSuccess();
+    }
+
+    /// bytes of a file, empty when it can not be read
+    inline std::vector<char> read_file( const std::string & path )
+    {
+        std::ifstream file( path, std::ios::binary );
+        return std::vector<char>( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    }
+
+    /// snapshot of mesh as bytes, equal bytes mean equal elements, links, ids and free lists
+    inline std::vector<char> snapshot_bytes( const LinkedMesh & mesh, const std::string & path )
+    {
+        EXPECT_TRUE( mesh.save_snapshot( path ) );
+        return read_file( path );
+    }
+}
@@ -4,12 +4,12 @@
 
 struct Vertex
 {
-	Vertex( uint id, vec3 position, vec4 color ) : id( id ), position( position ), color( color ) /*, edge( nullptr )*/
+	Vertex( uint id, vec3 position, vec4 color ) : id( id ), position( position ), color( color ), edge( nullptr )
 	{
 
 	};
 
-	Vertex( uint id, vec3 position ) : id( id ), position( position ), color( vec4( 1.0f, 1.0f, 1.0f, 1.0f ) )/*, edge( nullptr )*/
+	Vertex( uint id, vec3 position ) : id( id ), position( position ), color( vec4( 1.0f, 1.0f, 1.0f, 1.0f ) ), edge( nullptr )
 	{
 
 	};
@@ -17,6 +17,8 @@ struct Vertex
 	const uint id;
 	vec3 position;
 	vec4 color;
+	EdgeHandle edge;
 	float light = 0.5f;
 	bool initialized = false;
+	bool dirty = false;
 };
\ No newline at end of file